@@ -0,0 +1,381 @@
+/*
+ * AsyncIO: asynchronous page reads and writes for PageFile and BufferPool.
+ */
+
+#include "AsyncIO.h"
+#include "BufferPool.h"
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+AsyncIO::Request AsyncIO::requests[AsyncIO::QUEUE_DEPTH];
+int AsyncIO::queue[AsyncIO::QUEUE_DEPTH];
+int AsyncIO::queuedCount = 0;
+int AsyncIO::pendingCount = 0;
+RC  AsyncIO::writeError = 0;
+bool AsyncIO::reaping = false;
+
+//
+// the io_uring instance shared by all requests. the rings are used
+// through the raw system calls, so that no extra library is needed
+//
+static struct {
+  bool      initialized;
+  int       fd;            // -1 if io_uring is not available
+  unsigned* sqHead;
+  unsigned* sqTail;
+  unsigned* sqMask;
+  unsigned* sqArray;
+  unsigned* cqHead;
+  unsigned* cqTail;
+  unsigned* cqMask;
+  struct io_uring_sqe* sqes;
+  struct io_uring_cqe* cqes;
+} ring = { false, -1, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
+
+static int ringSetup(unsigned entries, struct io_uring_params* p)
+{
+#ifdef __NR_io_uring_setup
+  return (int)syscall(__NR_io_uring_setup, entries, p);
+#else
+  errno = ENOSYS;
+  return -1;
+#endif
+}
+
+static int ringEnter(unsigned toSubmit, unsigned minComplete, unsigned flags)
+{
+#ifdef __NR_io_uring_enter
+  return (int)syscall(__NR_io_uring_enter, ring.fd, toSubmit, minComplete, flags, NULL, 0);
+#else
+  errno = ENOSYS;
+  return -1;
+#endif
+}
+
+void AsyncIO::init()
+{
+  if (ring.initialized) return;
+  ring.initialized = true;
+
+  for (int i = 0; i < QUEUE_DEPTH; i++) requests[i].state = FREE;
+
+  struct io_uring_params p;
+  memset(&p, 0, sizeof(p));
+  int fd = ringSetup(QUEUE_DEPTH, &p);
+  if (fd < 0) return;
+
+  // map the submission queue, the completion queue and the sqe array
+  size_t sqLen = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+  size_t cqLen = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+  bool   single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single && cqLen > sqLen) sqLen = cqLen;
+
+  void* sq = mmap(NULL, sqLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  void* cq = sq;
+  if (sq != MAP_FAILED && !single) {
+    cq = mmap(NULL, cqLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+  }
+  void* sqes = mmap(NULL, p.sq_entries * sizeof(struct io_uring_sqe), PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+  if (sq == MAP_FAILED || cq == MAP_FAILED || sqes == MAP_FAILED) {
+    // the mappings go away with the descriptor
+    close(fd);
+    return;
+  }
+
+  char* s = (char*)sq;
+  char* c = (char*)cq;
+  ring.sqHead  = (unsigned*)(s + p.sq_off.head);
+  ring.sqTail  = (unsigned*)(s + p.sq_off.tail);
+  ring.sqMask  = (unsigned*)(s + p.sq_off.ring_mask);
+  ring.sqArray = (unsigned*)(s + p.sq_off.array);
+  ring.cqHead  = (unsigned*)(c + p.cq_off.head);
+  ring.cqTail  = (unsigned*)(c + p.cq_off.tail);
+  ring.cqMask  = (unsigned*)(c + p.cq_off.ring_mask);
+  ring.cqes    = (struct io_uring_cqe*)(c + p.cq_off.cqes);
+  ring.sqes    = (struct io_uring_sqe*)sqes;
+  ring.fd = fd;
+}
+
+bool AsyncIO::usingRing()
+{
+  init();
+  return ring.fd >= 0;
+}
+
+int AsyncIO::getSlot()
+{
+  init();
+
+  // make room by completing the requests in flight
+  while (pendingCount >= QUEUE_DEPTH) {
+    if (queuedCount > 0) submit();
+    if (!reap(true)) break;
+  }
+
+  for (int i = 0; i < QUEUE_DEPTH; i++) {
+    if (requests[i].state == FREE) return i;
+  }
+  return -1;
+}
+
+RC AsyncIO::queueRead(int fd, off_t offset, char* const* frames, int count, int length, int fileId, PageId pid)
+{
+  if (count <= 0 || count > MAX_READ_RUN) return RC_INVALID_ATTRIBUTE;
+
+  int slot = getSlot();
+  if (slot < 0) return RC_OUT_OF_MEMORY;
+
+  Request& r = requests[slot];
+  r.state = QUEUED;
+  r.write = false;
+  r.fd = fd;
+  r.offset = offset;
+  for (int i = 0; i < count; i++) {
+    r.pages[i].iov_base = frames[i];
+    r.pages[i].iov_len = length;
+  }
+  r.iov = r.pages;
+  r.iovcnt = count;
+  r.length = (size_t)count * length;
+  r.fileId = fileId;
+  r.pid = pid;
+
+  queue[queuedCount++] = slot;
+  pendingCount++;
+  return 0;
+}
+
+RC AsyncIO::queueWrite(int fd, off_t offset, const struct iovec* iov, int iovcnt)
+{
+  int slot = getSlot();
+  if (slot < 0) return RC_OUT_OF_MEMORY;
+
+  Request& r = requests[slot];
+  r.state = QUEUED;
+  r.write = true;
+  r.fd = fd;
+  r.offset = offset;
+  r.iov = iov;
+  r.iovcnt = iovcnt;
+  r.length = 0;
+  for (int i = 0; i < iovcnt; i++) r.length += iov[i].iov_len;
+  r.fileId = -1;
+  r.pid = -1;
+
+  queue[queuedCount++] = slot;
+  pendingCount++;
+  return 0;
+}
+
+RC AsyncIO::submit()
+{
+  init();
+  if (queuedCount == 0) return 0;
+
+  // without io_uring, do the queued requests right now. they are taken
+  // off the queue first, since other threads may queue and submit more
+  // while the latch is released for the transfers
+  if (ring.fd < 0) {
+    int slots[QUEUE_DEPTH];
+    int count = queuedCount;
+    memcpy(slots, queue, count * sizeof(int));
+    queuedCount = 0;
+    for (int i = 0; i < count; i++) requests[slots[i]].state = IN_FLIGHT;
+    for (int i = 0; i < count; i++) finishSync(slots[i], 0);
+    return 0;
+  }
+
+  // put the requests into the submission queue. we are the only producer,
+  // so only the kernel's view of the tail needs the release barrier
+  unsigned tail = *ring.sqTail;
+  unsigned mask = *ring.sqMask;
+  for (int i = 0; i < queuedCount; i++) {
+    Request& r = requests[queue[i]];
+    unsigned index = tail & mask;
+    struct io_uring_sqe* sqe = &ring.sqes[index];
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = r.write ? IORING_OP_WRITEV : IORING_OP_READV;
+    sqe->fd = r.fd;
+    sqe->off = r.offset;
+    sqe->addr = (unsigned long)r.iov;
+    sqe->len = r.iovcnt;
+    sqe->user_data = queue[i];
+
+    ring.sqArray[index] = index;
+    r.state = IN_FLIGHT;
+    tail++;
+  }
+  __atomic_store_n(ring.sqTail, tail, __ATOMIC_RELEASE);
+
+  int count = queuedCount;
+  queuedCount = 0;
+  while (count > 0) {
+    int n = ringEnter(count, 0, 0);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) {
+      // the kernel did not take the rest of the requests. take them
+      // back from the submission queue and do them ourselves
+      int      slots[QUEUE_DEPTH];
+      int      left = 0;
+      unsigned head = __atomic_load_n(ring.sqHead, __ATOMIC_ACQUIRE);
+      for (unsigned t = head; t != tail; t++) slots[left++] = (int)ring.sqes[t & mask].user_data;
+      __atomic_store_n(ring.sqTail, head, __ATOMIC_RELEASE);
+      for (int i = 0; i < left; i++) finishSync(slots[i], 0);
+      return 0;
+    }
+    count -= n;
+  }
+
+  // the threads waiting for a page whose read was queued can reap it now
+  BufferPool::wakeUp();
+  return 0;
+}
+
+RC AsyncIO::wait()
+{
+  submit();
+  while (pendingCount > 0 && reap(true)) {}
+
+  RC rc = writeError;
+  writeError = 0;
+  return rc;
+}
+
+void AsyncIO::waitFor(int fileId, PageId pid)
+{
+  for (;;) {
+    int slot = -1;
+    for (int i = 0; i < QUEUE_DEPTH; i++) {
+      if (requests[i].state != FREE && !requests[i].write && requests[i].fileId == fileId &&
+          pid >= requests[i].pid && pid < requests[i].pid + requests[i].iovcnt) slot = i;
+    }
+    if (slot < 0) return;
+
+    if (requests[slot].state == QUEUED) submit();
+    else if (!reap(true)) return;
+  }
+}
+
+bool AsyncIO::reap(bool block)
+{
+  // without io_uring, the requests in flight are transferred by the
+  // threads that submitted them. if another thread waits in the kernel,
+  // it reaps the completions for us. either way, we wait for the others
+  if (ring.fd < 0 || reaping) {
+    if (!block) return false;
+
+    bool inFlight = false;
+    for (int i = 0; i < QUEUE_DEPTH && !inFlight; i++) inFlight = (requests[i].state == IN_FLIGHT);
+    if (!inFlight) return false;
+
+    BufferPool::sleep();
+    return true;
+  }
+
+  bool reaped = false;
+  for (;;) {
+    // the head is read again after every completion, since complete()
+    // may release the latch and let another thread reap meanwhile
+    unsigned head;
+    while ((head = *ring.cqHead) != __atomic_load_n(ring.cqTail, __ATOMIC_ACQUIRE)) {
+      struct io_uring_cqe* cqe = &ring.cqes[head & *ring.cqMask];
+      int   slot = (int)cqe->user_data;
+      int   res = cqe->res;
+      __atomic_store_n(ring.cqHead, head + 1, __ATOMIC_RELEASE);
+      complete(slot, res);
+      reaped = true;
+    }
+    if (reaped) BufferPool::wakeUp();
+    if (reaped || !block) return reaped;
+
+    // nothing is complete yet. sleep until something is, without the latch
+    bool inFlight = false;
+    for (int i = 0; i < QUEUE_DEPTH && !inFlight; i++) inFlight = (requests[i].state == IN_FLIGHT);
+    if (!inFlight) return false;
+
+    reaping = true;
+    BufferPool::unlock();
+    int n = ringEnter(0, 1, IORING_ENTER_GETEVENTS);
+    int error = errno;
+    BufferPool::lock();
+    reaping = false;
+    BufferPool::wakeUp();
+    if (n < 0 && error != EINTR) return false;
+  }
+}
+
+void AsyncIO::complete(int slot, ssize_t result)
+{
+  Request& r = requests[slot];
+
+  // a failed read only means that the page has to be read again later.
+  // a short transfer is finished synchronously
+  if (result < 0 && r.write) {
+    if (writeError == 0) writeError = RC_FILE_WRITE_FAILED;
+  } else if (result >= 0 && (size_t)result < r.length) {
+    finishSync(slot, result);
+    return;
+  }
+
+  if (!r.write) endRead(slot, result);
+  r.state = FREE;
+  pendingCount--;
+}
+
+void AsyncIO::endRead(int slot, ssize_t done)
+{
+  Request& r = requests[slot];
+
+  // every page that was read completely has arrived
+  for (int i = 0; i < r.iovcnt; i++) {
+    bool ok = done >= (ssize_t)((i + 1) * r.pages[i].iov_len);
+    BufferPool::endLoad(r.fileId, r.pid + i, ok);
+  }
+}
+
+void AsyncIO::finishSync(int slot, ssize_t done)
+{
+  Request& r = requests[slot];
+  bool ok = true;
+
+  // transfer the bytes from the done'th byte on. the request is
+  // IN_FLIGHT and its frames are pinned, so the latch is not needed
+  BufferPool::unlock();
+  while ((size_t)done < r.length) {
+    struct iovec iov[IOV_MAX];
+    const struct iovec* v = r.iov;
+    int vcnt = r.iovcnt;
+    size_t skip = done;
+    while (vcnt > 0 && skip >= v->iov_len) { skip -= v->iov_len; v++; vcnt--; }
+    if (vcnt > IOV_MAX) vcnt = IOV_MAX;
+    memcpy(iov, v, vcnt * sizeof(struct iovec));
+    iov[0].iov_base = (char*)iov[0].iov_base + skip;
+    iov[0].iov_len -= skip;
+
+    ssize_t n = r.write ? ::pwritev(r.fd, iov, vcnt, r.offset + done)
+                        : ::preadv(r.fd, iov, vcnt, r.offset + done);
+    if (n < 0 && errno == EINTR) continue;
+    if (n < 0) { ok = false; break; }
+    if (n == 0) {
+      // the page is beyond the end of the file. the rest reads as zeros
+      if (r.write) { ok = false; break; }
+      for (int i = 0; i < vcnt; i++) memset(iov[i].iov_base, 0, iov[i].iov_len);
+      break;
+    }
+    done += n;
+  }
+  BufferPool::lock();
+
+  if (r.write && !ok && writeError == 0) writeError = RC_FILE_WRITE_FAILED;
+  if (!r.write) endRead(slot, ok ? (ssize_t)r.length : done);
+  r.state = FREE;
+  pendingCount--;
+  BufferPool::wakeUp();
+}
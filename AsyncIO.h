@@ -0,0 +1,124 @@
+/*
+ * AsyncIO: asynchronous page reads and writes for PageFile and BufferPool.
+ */
+
+#ifndef ASYNCIO_H
+#define ASYNCIO_H
+
+#include <sys/types.h>
+#include <sys/uio.h>
+#include "Bruinbase.h"
+#include "PageFile.h"
+
+/**
+ * A queue of reads and writes that are handed to the kernel in batches.
+ * Requests are queued with queueRead() and queueWrite(), go to the kernel
+ * with submit() and are completed by wait() or waitFor().
+ *
+ * The requests are issued through io_uring, so that up to QUEUE_DEPTH of
+ * them are in flight at the same time. If io_uring is not available
+ * (old kernel, or forbidden by a seccomp filter), submit() performs the
+ * queued requests right away with preadv()/pwritev().
+ *
+ * A read fills buffer pool frames set up by BufferPool::startLoad() and
+ * calls BufferPool::endLoad() for every page once the data has arrived.
+ *
+ * The caller holds the buffer pool latch. It is released while a thread
+ * sleeps in the kernel for completions, or transfers the data itself
+ * without io_uring; the other threads that wait meanwhile sleep in
+ * BufferPool::sleep() until that thread is done.
+ */
+class AsyncIO {
+ public:
+  static const int QUEUE_DEPTH = 64;   // # requests queued or in flight at most
+  static const int MAX_READ_RUN = 64;  // # pages read by a single request at most
+
+  /**
+   * queue a read of consecutive pages into buffer pool frames.
+   * if QUEUE_DEPTH requests are pending, some of them are completed first.
+   * @param fd[IN] the file to read from
+   * @param offset[IN] the offset of the first page in the file
+   * @param frames[IN] the buffer pool frames to read the pages into
+   * @param count[IN] # pages to read (at most MAX_READ_RUN)
+   * @param length[IN] the page size
+   * @param fileId[IN] the buffer pool file id of the pages
+   * @param pid[IN] the first page
+   * @return error code. 0 if no error
+   */
+  static RC queueRead(int fd, off_t offset, char* const* frames, int count, int length, int fileId, PageId pid);
+
+  /**
+   * queue a write of the buffers in iov to consecutive bytes of a file.
+   * iov and the buffers must stay untouched until wait() returns.
+   * @param fd[IN] the file to write to
+   * @param offset[IN] the offset in the file to write at
+   * @param iov[IN] the buffers to write
+   * @param iovcnt[IN] # buffers in iov
+   * @return error code. 0 if no error
+   */
+  static RC queueWrite(int fd, off_t offset, const struct iovec* iov, int iovcnt);
+
+  /**
+   * hand all queued requests to the kernel without waiting for them.
+   * @return error code. 0 if no error
+   */
+  static RC submit();
+
+  /**
+   * submit the queued requests and wait until all requests are complete.
+   * @return error code of the first write that failed since the last wait().
+   *         0 if no error. failed reads are not reported here: their pages
+   *         are dropped from the buffer pool and simply read again.
+   */
+  static RC wait();
+
+  /**
+   * wait until the read of a page queued by queueRead() is complete.
+   * nothing is done if the page is not being read.
+   * @param fileId[IN] the buffer pool file id of the page
+   * @param pid[IN] the page
+   */
+  static void waitFor(int fileId, PageId pid);
+
+  /**
+   * @return # requests queued or in flight
+   */
+  static int getPendingCount() { return pendingCount; }
+
+  /**
+   * @return true if the requests are issued through io_uring
+   */
+  static bool usingRing();
+
+ private:
+  enum State { FREE, QUEUED, IN_FLIGHT };
+
+  struct Request {
+    State  state;
+    bool   write;
+    int    fd;
+    off_t  offset;
+    struct iovec pages[MAX_READ_RUN];  // the frames of a read
+    const struct iovec* iov;   // the buffers to transfer
+    int    iovcnt;
+    size_t length;             // total # bytes to transfer
+    int    fileId;             // the pages of a read (-1 for a write):
+    PageId pid;                // iovcnt pages from pid on
+  };
+
+  static void init();
+  static int  getSlot();
+  static void complete(int slot, ssize_t result);
+  static void endRead(int slot, ssize_t done);
+  static void finishSync(int slot, ssize_t done);
+  static bool reap(bool block);
+
+  static Request requests[QUEUE_DEPTH];
+  static int     queue[QUEUE_DEPTH];  // the slots queued but not submitted
+  static int     queuedCount;
+  static int     pendingCount;        // # slots that are not FREE
+  static RC      writeError;          // the first write error since wait()
+  static bool    reaping;             // is a thread waiting in the kernel?
+};
+
+#endif // ASYNCIO_H
@@ -12,13 +12,29 @@
 
 #include <iostream>       // std::cout
 #include <queue>          // std::queue
+#include <algorithm>      // std::sort
 
 #include <stdlib.h>
 #include <cstring>
+#include <climits>
 
 
 using namespace std;
 
+//
+// the layout of the header page (page 0) of an index file
+//
+static const int INDEX_MAGIC   = 0x42425449;  // "ITBB" on little endian
+static const int INDEX_VERSION = 1;           // the index file format version
+
+struct IndexMetadata {
+  int    magic;       // INDEX_MAGIC
+  int    version;     // INDEX_VERSION
+  PageId rootPid;     // the PageId of the root node (-1 if the tree is empty)
+  int    treeHeight;  // the height of the tree (0 if the tree is empty)
+  int    keyCount;    // the number of entries in the tree
+};
+
 /*
  * BTreeIndex constructor
  */
@@ -26,6 +42,9 @@ BTreeIndex::BTreeIndex()
 {
     rootPid = -1;
     treeHeight = 0;
+    keyCount = 0;
+    writable = false;
+    bulkLoading = false;
 }
 
 /*
@@ -43,17 +62,32 @@ RC BTreeIndex::open(const string& indexname, char mode){
 		return val;
 	}
 
-	//if the file openned successfully, we set the rootPid to zero
-
-	rootPid = 0; 
- 	
- 	//Write an empty root node (which is a leaf node)
-	if(pf.endPid() <= 0) { 
-		BTLeafNode leaf;
-		int t = leaf.write(rootPid,pf);
+	indexName = indexname;
+	writable = (mode == 'w' || mode == 'W');
+	bulkLoading = false;
+	rootPid = -1;
+	treeHeight = 0;
+	keyCount = 0;
+	path.clear();
+
+	//A new index file starts with the header page of an empty tree
+	if(pf.endPid() <= 0) {
+		if (!writable) return 0;
+		val = writeMetadata();
+	}
+	else {
+		val = readMetadata();
 	}
 
-	return 0;
+	//lookups jump around the index file, so read-ahead does not help
+	if (val == 0 && !writable) pf.advise(PageFile::RANDOM);
+
+	if (val != 0) {
+		pf.close();
+		rootPid = RC_INVALID_PID;
+		writable = false;
+	}
+	return val;
 }
 
 /*
@@ -61,8 +95,63 @@ RC BTreeIndex::open(const string& indexname, char mode){
  * @return error code. 0 if no error
  */
 RC BTreeIndex::close(){
+	RC err = 0;
+
+	//save the root and height of the tree, so that the
+	//index can be opened and searched again later
+	if (writable) err = writeMetadata();
+
+	RC closeErr = pf.close();
+	path.clear();
 	rootPid = RC_INVALID_PID;
-	return pf.close();
+	treeHeight = 0;
+	keyCount = 0;
+	writable = false;
+	return (err != 0) ? err : closeErr;
+}
+
+/*
+ * Read the tree metadata from the header page of the index file.
+ * @return error code. 0 if no error
+ */
+RC BTreeIndex::readMetadata()
+{
+	char page[PageFile::MAX_PAGE_SIZE];
+	IndexMetadata meta;
+
+	RC err = pf.read(0, page);
+	if (err != 0) return err;
+
+	memcpy(&meta, page, sizeof(meta));
+	if (meta.magic != INDEX_MAGIC || meta.version != INDEX_VERSION)
+		return RC_INVALID_FILE_FORMAT;
+	if (meta.treeHeight < 0 || meta.rootPid >= pf.endPid())
+		return RC_INVALID_FILE_FORMAT;
+
+	rootPid = meta.rootPid;
+	treeHeight = meta.treeHeight;
+	keyCount = meta.keyCount;
+	return 0;
+}
+
+/*
+ * Write the tree metadata to the header page of the index file.
+ * @return error code. 0 if no error
+ */
+RC BTreeIndex::writeMetadata()
+{
+	char page[PageFile::MAX_PAGE_SIZE];
+	IndexMetadata meta;
+
+	meta.magic = INDEX_MAGIC;
+	meta.version = INDEX_VERSION;
+	meta.rootPid = rootPid;
+	meta.treeHeight = treeHeight;
+	meta.keyCount = keyCount;
+
+	memset(page, 0, pf.getPageSize());
+	memcpy(page, &meta, sizeof(meta));
+	return pf.write(0, page);
 }
 
 /*
@@ -73,11 +162,14 @@ RC BTreeIndex::close(){
  */
 RC BTreeIndex::insert(int key, const RecordId& rid)
 {
+	// a split changes the nodes on the path of the last search
+	path.clear();
+
 	// if nothing has been added
 	if (treeHeight == 0)
 	{
 		RC err;
-		BTLeafNode firstAdd;
+		BTLeafNode firstAdd(pf.getPageSize());
 
 		err = firstAdd.insert(key, rid);
 
@@ -87,19 +179,25 @@ RC BTreeIndex::insert(int key, const RecordId& rid)
 
 		rootPid = pf.endPid();
 
+		err = firstAdd.write(rootPid, pf);
+		if (err != 0) return err;
+
 		treeHeight++;
-		return firstAdd.write(rootPid, pf);
+		keyCount++;
+		return 0;
 	}
 
 	int keyLocator = -100;
 	PageId pageLocator = -100;
 
-    return insertHelper(key, rid, 1, rootPid, keyLocator, pageLocator);
+	RC err = insertHelper(key, rid, 1, rootPid, keyLocator, pageLocator);
+	if (err == 0) keyCount++;
+	return err;
 }
 RC BTreeIndex::insertHelper(int key, const RecordId& rid, int level, PageId currPage, int& keyLocator, PageId &pageLocator){
 	if (level == treeHeight)
 	{
-		BTLeafNode leafToInsert;
+		BTLeafNode leafToInsert(pf.getPageSize());
 		RC err;
 		err = leafToInsert.read(currPage, pf);
 		if (err != 0) return err;
@@ -112,7 +210,7 @@ RC BTreeIndex::insertHelper(int key, const RecordId& rid, int level, PageId curr
 		}
 
 		//split necessary
-		BTLeafNode neighbor;
+		BTLeafNode neighbor(pf.getPageSize());
 		int nextKey;
 		err = leafToInsert.insertAndSplit(key, rid, neighbor, nextKey);
 		if (err != 0) return err;
@@ -132,11 +230,9 @@ RC BTreeIndex::insertHelper(int key, const RecordId& rid, int level, PageId curr
 		if (err != 0) return err;
 
 		if (level == 1){
-			BTNonLeafNode root;
+			BTNonLeafNode root(pf.getPageSize());
 
 			int err;
-			cout << currPage << endl;
-			cout << pidPointer << endl;
 			err = root.initializeRoot(currPage, nextKey, pidPointer);
 			if (err != 0)return err;
 
@@ -151,7 +247,7 @@ RC BTreeIndex::insertHelper(int key, const RecordId& rid, int level, PageId curr
 	}
 	else{
 
-		BTNonLeafNode nodeToSearch;
+		BTNonLeafNode nodeToSearch(pf.getPageSize());
 		RC err;
 		err = nodeToSearch.read(currPage, pf);
 		if (err != 0){
@@ -164,43 +260,362 @@ RC BTreeIndex::insertHelper(int key, const RecordId& rid, int level, PageId curr
 			return err;
 
 		err = insertHelper(key, rid, level + 1, childId, keyLocator, pageLocator);
-		// need to insert into the non leaf
-		if (err == 0 && (keyLocator != -100 && pageLocator != -100)){
-			err = nodeToSearch.insert(keyLocator, pageLocator);
-			if (err == 0){
-				nodeToSearch.write(currPage, pf);
-				return 0;
-			}
+		if (err != 0) return err;
+
+		// the child did not split, so there is nothing to add to this node
+		if (keyLocator == -100 && pageLocator == -100) return 0;
+
+		// need to insert the new child into the non leaf
+		int childKey = keyLocator;
+		PageId childPid = pageLocator;
+		keyLocator = -100;
+		pageLocator = -100;
 
-			BTNonLeafNode second;
-			int midKey;
+		err = nodeToSearch.insert(childKey, childPid);
+		if (err == 0){
+			return nodeToSearch.write(currPage, pf);
+		}
+
+		BTNonLeafNode second(pf.getPageSize());
+		int midKey;
+
+		err = nodeToSearch.insertAndSplit(childKey, childPid, second, midKey);
+		if (err != 0)return err;
+
+		int pidPointer = pf.endPid();
+		err = nodeToSearch.write(currPage, pf);
+		if (err != 0)return err;
+
+		err = second.write(pidPointer, pf);
+		if (err != 0) return err;
+
+		if (level == 1){
+
+			BTNonLeafNode root(pf.getPageSize());
+			err = root.initializeRoot(currPage, midKey, pidPointer);
 
-			err = nodeToSearch.insertAndSplit(key, currPage, second, midKey);
 			if (err != 0)return err;
 
-			int pidPointer = pf.endPid();
-			err = nodeToSearch.write(currPage, pf);
+			rootPid = pf.endPid();
+			err = root.write(rootPid, pf);
 			if (err != 0)return err;
 
-			err = second.write(pidPointer, pf);
-			if (err != 0) return err;
+			treeHeight++;
+		}
+		else{
+			// the split has to be propagated to the parent node
+			keyLocator = midKey;
+			pageLocator = pidPointer;
+		}
+		return 0;
+	}
+}
 
-			if (level == 1){
+//
+// helper functions and classes for bulk loading
+//
 
-				BTNonLeafNode root;
-				err = root.initializeRoot(currPage, midKey, pidPointer);
+// compare two index entries by key (and by RecordId for equal keys)
+static bool entryLess(const IndexEntry& e1, const IndexEntry& e2)
+{
+	if (e1.key != e2.key) return e1.key < e2.key;
+	return e1.rid < e2.rid;
+}
 
-				if (err != 0)return err;
+// number of index entries stored in one page of a run file
+static int runEntriesPerPage(const PageFile& run)
+{
+	return run.getPageSize() / sizeof(IndexEntry);
+}
 
-				rootPid = pf.endPid();
-				root.write(rootPid, pf);
-				treeHeight++;
+/**
+ * Returns the entries of a bulk load in sorted order, one at a time,
+ * by merging the sorted in-memory buffer with the sorted run files.
+ */
+class IndexEntrySource {
+ public:
+	IndexEntrySource(const vector<IndexEntry>& entries) : memory(entries), memPos(0) {}
+	~IndexEntrySource();
+
+	// add a sorted run file with count entries to the merge
+	RC addRun(const string& name, int count);
+
+	// get the next smallest entry. RC_END_OF_TREE if there is none left
+	RC next(IndexEntry& entry);
+
+ private:
+	struct Run {
+		PageFile   pf;         // the run file
+		PageId     pid;        // the page loaded in page
+		int        remaining;  // # entries not returned yet
+		int        pos;        // position of head in page
+		int        perPage;    // # entries in a page of the run file
+		IndexEntry head;       // the smallest entry not returned yet
+		char       page[PageFile::MAX_PAGE_SIZE];
+	};
+	RC advance(Run* run);
+
+	vector<Run*> runs;
+	const vector<IndexEntry>& memory;
+	unsigned memPos;
+};
+
+IndexEntrySource::~IndexEntrySource()
+{
+	for (unsigned i = 0; i < runs.size(); i++) {
+		runs[i]->pf.close();
+		delete runs[i];
+	}
+}
 
+RC IndexEntrySource::addRun(const string& name, int count)
+{
+	Run* run = new Run;
+	RC err = run->pf.open(name, 'r');
+	if (err != 0) { delete run; return err; }
+
+	run->pid = -1;
+	run->perPage = runEntriesPerPage(run->pf);
+	run->pos = run->perPage - 1;
+	run->remaining = count;
+	runs.push_back(run);
+
+	// load the first entry of the run
+	if (count > 0) return advance(run);
+	return 0;
+}
+
+RC IndexEntrySource::advance(Run* run)
+{
+	// move to the next page of the run file if the current one is used up
+	if (++run->pos >= run->perPage) {
+		RC err = run->pf.read(++run->pid, run->page);
+		if (err != 0) return err;
+		run->pos = 0;
+	}
+	memcpy(&run->head, run->page + run->pos * sizeof(IndexEntry), sizeof(IndexEntry));
+	return 0;
+}
+
+RC IndexEntrySource::next(IndexEntry& entry)
+{
+	// find the source with the smallest head entry
+	Run* minRun = NULL;
+	bool fromMemory = (memPos < memory.size());
+	if (fromMemory) entry = memory[memPos];
+
+	for (unsigned i = 0; i < runs.size(); i++) {
+		if (runs[i]->remaining <= 0) continue;
+		if ((!fromMemory && minRun == NULL) || entryLess(runs[i]->head, entry)) {
+			minRun = runs[i];
+			entry = minRun->head;
+			fromMemory = false;
+		}
+	}
+
+	if (fromMemory) {
+		memPos++;
+		return 0;
+	}
+	if (minRun == NULL) return RC_END_OF_TREE;
+
+	if (--minRun->remaining > 0) return advance(minRun);
+	return 0;
+}
+
+/*
+ * Start building an empty index bottom-up.
+ * @return error code. 0 if no error
+ */
+RC BTreeIndex::beginBulkLoad()
+{
+	if (!writable || treeHeight != 0 || bulkLoading) return RC_INVALID_ATTRIBUTE;
+
+	bulkLoading = true;
+	bulkEntries.clear();
+	bulkRuns.clear();
+	return 0;
+}
+
+/*
+ * Add a (key, RecordId) pair to the index being bulk loaded.
+ * @param key[IN] the key for the value inserted into the index
+ * @param rid[IN] the RecordId for the record being inserted into the index
+ * @return error code. 0 if no error
+ */
+RC BTreeIndex::bulkInsert(int key, const RecordId& rid)
+{
+	if (!bulkLoading) return RC_INVALID_ATTRIBUTE;
+
+	IndexEntry entry;
+	entry.key = key;
+	entry.rid = rid;
+	bulkEntries.push_back(entry);
+
+	// the buffer is full. write it out as a sorted run
+	if ((int)bulkEntries.size() >= BULK_RUN_ENTRIES) return spillRun();
+	return 0;
+}
+
+/*
+ * Sort and merge all bulk loaded pairs and build the tree bottom-up.
+ * @return error code. 0 if no error
+ */
+RC BTreeIndex::endBulkLoad()
+{
+	if (!bulkLoading) return RC_INVALID_ATTRIBUTE;
+	bulkLoading = false;
+
+	RC err = 0;
+	int total = bulkEntries.size();
+
+	// the last buffer stays in memory and is merged with the runs
+	sort(bulkEntries.begin(), bulkEntries.end(), entryLess);
+
+	{
+		IndexEntrySource source(bulkEntries);
+		for (unsigned i = 0; i < bulkRuns.size() && err == 0; i++) {
+			err = source.addRun(bulkRuns[i].first, bulkRuns[i].second);
+			total += bulkRuns[i].second;
+		}
+
+		if (err == 0 && total > 0) {
+			vector<pair<int, PageId> > level;
+			vector<pair<int, PageId> > parents;
+			int height = 1;
+
+			// build the leaf level and then add nonleaf levels
+			// until there is a single node at the top
+			err = buildLeafLevel(source, level);
+			while (err == 0 && level.size() > 1) {
+				parents.clear();
+				err = buildNonLeafLevel(level, parents);
+				level.swap(parents);
+				height++;
 			}
 
+			if (err == 0) {
+				rootPid = level[0].second;
+				treeHeight = height;
+				keyCount = total;
+				path.clear();
+			}
 		}
+	}
 
+	// remove the run files
+	for (unsigned i = 0; i < bulkRuns.size(); i++) {
+		PageFile::remove(bulkRuns[i].first);
 	}
+	bulkEntries.clear();
+	bulkRuns.clear();
+	return err;
+}
+
+/*
+ * Sort the buffered pairs and write them to a new run file.
+ * @return error code. 0 if no error
+ */
+RC BTreeIndex::spillRun()
+{
+	PageFile run;
+	char page[PageFile::MAX_PAGE_SIZE];
+	RC err;
+
+	sort(bulkEntries.begin(), bulkEntries.end(), entryLess);
+
+	string name;
+	if ((err = run.openTemp(indexName + ".run", name)) != 0) return err;
+
+	int count = bulkEntries.size();
+	int perPage = runEntriesPerPage(run);
+	for (int i = 0; i < count && err == 0; i += perPage) {
+		int n = min(perPage, count - i);
+		memset(page, 0, run.getPageSize());
+		memcpy(page, &bulkEntries[i], n * sizeof(IndexEntry));
+		err = run.write(i / perPage, page);
+	}
+	run.close();
+	if (err != 0) {
+		PageFile::remove(name);
+		return err;
+	}
+
+	bulkRuns.push_back(make_pair(name, count));
+	bulkEntries.clear();
+	return 0;
+}
+
+/*
+ * Pack the sorted entries into leaf nodes written at the end of the
+ * index file. The entries are spread evenly over the leaves, so that no
+ * leaf is fuller than the fill factor and the last leaf is not nearly empty.
+ * @param source[IN] the sorted entries
+ * @param parents[OUT] the (first key, PageId) pair of every leaf
+ * @return error code. 0 if no error
+ */
+RC BTreeIndex::buildLeafLevel(IndexEntrySource& source, vector<pair<int, PageId> >& parents)
+{
+	BTLeafNode probe(pf.getPageSize());
+	int total = bulkEntries.size();
+	for (unsigned i = 0; i < bulkRuns.size(); i++) total += bulkRuns[i].second;
+
+	int perLeaf = max(1, probe.getMaxKeyCount() * BULK_FILL_PERCENT / 100);
+	int leaves = (total + perLeaf - 1) / perLeaf;
+	PageId pid = pf.endPid();
+
+	for (int i = 0; i < leaves; i++, pid++) {
+		BTLeafNode leaf(pf.getPageSize());
+		IndexEntry entry;
+		int n = total / leaves + ((i < total % leaves) ? 1 : 0);
+		RC err;
+
+		for (int j = 0; j < n; j++) {
+			if ((err = source.next(entry)) != 0) return err;
+			if ((err = leaf.insert(entry.key, entry.rid)) != 0) return err;
+			if (j == 0) parents.push_back(make_pair(entry.key, pid));
+		}
+
+		// the leaves are written to consecutive pages,
+		// so the next leaf is always on the following page
+		if (i < leaves - 1) leaf.setNextNodePtr(pid + 1);
+		if ((err = leaf.write(pid, pf)) != 0) return err;
+	}
+	return 0;
+}
+
+/*
+ * Build one nonleaf level on top of the given child nodes.
+ * @param children[IN] the (first key, PageId) pair of every child node
+ * @param parents[OUT] the (first key, PageId) pair of every new node
+ * @return error code. 0 if no error
+ */
+RC BTreeIndex::buildNonLeafLevel(const vector<pair<int, PageId> >& children, vector<pair<int, PageId> >& parents)
+{
+	BTNonLeafNode probe(pf.getPageSize());
+	int total = children.size();
+	int perNode = max(3, (probe.getMaxKeyCount() + 1) * BULK_FILL_PERCENT / 100);
+	int nodes = (total + perNode - 1) / perNode;
+	PageId pid = pf.endPid();
+	int next = 0;
+
+	for (int i = 0; i < nodes; i++, pid++) {
+		BTNonLeafNode node(pf.getPageSize());
+		int n = total / nodes + ((i < total % nodes) ? 1 : 0);
+		RC err;
+
+		// every child but the first one is separated by its first key
+		err = node.initializeRoot(children[next].second, children[next+1].first, children[next+1].second);
+		if (err != 0) return err;
+		for (int j = 2; j < n; j++) {
+			if ((err = node.insert(children[next+j].first, children[next+j].second)) != 0) return err;
+		}
+
+		if ((err = node.write(pid, pf)) != 0) return err;
+		parents.push_back(make_pair(children[next].first, pid));
+		next += n;
+	}
+	return 0;
 }
 
 /**
@@ -223,15 +638,23 @@ RC BTreeIndex::insertHelper(int key, const RecordId& rid, int level, PageId curr
  */
 RC BTreeIndex::locate(int searchKey, IndexCursor& cursor)
 {
-	RC err;
 	if (treeHeight == 0){
-		return RC_NO_SUCH_RECORD;
+		return RC_END_OF_TREE;
 	}
-	else{
-		//follow root pid to the root and go from there -> recursive function
-		err = locateHelper(searchKey, cursor, 1, rootPid);
+
+	//Go back up the path of the last search until a node whose keys
+	//include searchKey, and go down from there. The root has all keys
+	int level = path.size();
+	while (level > 1 && (searchKey <= path[level - 1].low || searchKey > path[level - 1].high)) level--;
+	if (level == 0) {
+		PathNode root;
+		root.pid = rootPid;
+		root.low = (long long)INT_MIN - 1;
+		root.high = INT_MAX;
+		path.push_back(root);
+		level = 1;
 	}
-    return err;
+	return locateHelper(searchKey, cursor, level, path[level - 1].pid);
 }
 RC BTreeIndex::locateHelper(int searchKey, IndexCursor &cursor, int level, PageId pid_looper)
 {
@@ -239,28 +662,46 @@ RC BTreeIndex::locateHelper(int searchKey, IndexCursor &cursor, int level, PageI
 		BTLeafNode searchNode;
 
 		int err;
-		err = searchNode.read(pid_looper, pf);
+		err = searchNode.view(pid_looper, pf);
 		if (err != 0) return err;
 
+		// the cursor is set even if searchKey is not in the leaf,
+		// so that the caller can start a range scan from there
 		int eid_found;
 		err = searchNode.locate(searchKey, eid_found);
 
-		if (err != 0) return err;
-
 		cursor.pid = pid_looper;
 		cursor.eid = eid_found;
-		return 0;
+
+		// every key of the leaf is smaller than searchKey. the entries
+		// with searchKey, if any, start at the first entry of the next leaf
+		if (eid_found >= searchNode.getKeyCount() && searchNode.getNextNodePtr() != 0) {
+			cursor.pid = searchNode.getNextNodePtr();
+			if ((err = searchNode.view(cursor.pid, pf)) != 0) return err;
+			err = searchNode.locate(searchKey, eid_found);
+			cursor.eid = eid_found;
+		}
+		return err;
 	}
 	else{
 		BTNonLeafNode searchNode;
 		int err;
-		err = searchNode.read(pid_looper, pf);
+		err = searchNode.view(pid_looper, pf);
 		if (err != 0) return err;
 
 		int new_pid;
-		err = searchNode.locateChildPtr(searchKey, new_pid);
+		long long low, high;
+		err = searchNode.locateFirstChildPtr(searchKey, new_pid, low, high);
 		if (err != 0) return err;
 
+		//Remember the child and the keys this node sends to it
+		PathNode child;
+		child.pid = new_pid;
+		child.low = (low > path[level - 1].low) ? low : path[level - 1].low;
+		child.high = (high < path[level - 1].high) ? high : path[level - 1].high;
+		path.resize(level);
+		path.push_back(child);
+
 		return locateHelper(searchKey, cursor, level + 1, new_pid);
 	}
 }
@@ -273,6 +714,33 @@ RC BTreeIndex::locateHelper(int searchKey, IndexCursor &cursor, int level, PageI
  * @param rid[OUT] the RecordId stored at the index cursor location.
  * @return error code. 0 if no error
  */
+RC BTreeIndex::locateLast(int searchKey, int& key, RecordId& rid)
+{
+	RC err;
+	if (treeHeight == 0) return RC_END_OF_TREE;
+
+	//A nonleaf node sends searchKey to its rightmost child whose
+	//keys start at or before searchKey, so following it down to
+	//the leaf level reaches the last entry not greater than searchKey
+
+	PageId pid = rootPid;
+	for (int level = 1; level < treeHeight; level++) {
+		BTNonLeafNode node;
+		if ((err = node.view(pid, pf)) != 0) return err;
+		if ((err = node.locateChildPtr(searchKey, pid)) != 0) return err;
+	}
+
+	BTLeafNode leaf;
+	if ((err = leaf.view(pid, pf)) != 0) return err;
+
+	//The entries of the leaf are sorted, so look from the end
+	for (int eid = leaf.getKeyCount() - 1; eid >= 0; eid--) {
+		if ((err = leaf.readEntry(eid, key, rid)) != 0) return err;
+		if (key <= searchKey) return 0;
+	}
+	return RC_NO_SUCH_RECORD;
+}
+
 RC BTreeIndex::readForward(IndexCursor& cursor, int& key, RecordId& rid){
 	//First let's get the necessary details from the
 	//cursor that's provided to us
@@ -285,10 +753,30 @@ RC BTreeIndex::readForward(IndexCursor& cursor, int& key, RecordId& rid){
 
 	RC retVal;
 
+	//Page 0 never holds a leaf, so a zero next-node pointer
+	//marks the end of the leaf chain
+
+	if (cursorPID==0) {return RC_END_OF_TREE;}
+
 	BTLeafNode leaf;
-	retVal = leaf.read(cursorPID,pf);
+	retVal = leaf.view(cursorPID,pf);
 
 	if(retVal!=0) {return retVal;}
+
+	//locate() may leave the cursor right behind the last entry
+	//of a leaf. In that case continue with the next leaf
+
+	while(cursorEID>=leaf.getKeyCount()){
+		cursorEID = 0;
+		cursorPID = leaf.getNextNodePtr();
+		if (cursorPID==0) {
+			cursor.pid = cursorPID;
+			cursor.eid = cursorEID;
+			return RC_END_OF_TREE;
+		}
+		retVal = leaf.view(cursorPID,pf);
+		if(retVal!=0) {return retVal;}
+	}
 	
 	//What we need to do is to reconfirm that we are able
 	//To read the entry 
@@ -10,6 +10,9 @@
 #ifndef BTREEINDEX_H
 #define BTREEINDEX_H
 
+#include <string>
+#include <utility>
+#include <vector>
 #include "Bruinbase.h"
 #include "PageFile.h"
 #include "RecordFile.h"
@@ -27,20 +30,34 @@ typedef struct {
   int     eid;  
 } IndexCursor;
 
+/**
+ * A (key, RecordId) pair stored in a b+tree leaf node.
+ */
+typedef struct {
+  int      key;
+  RecordId rid;
+} IndexEntry;
+
+class IndexEntrySource;
+
 /**
  * Implements a B-Tree index for bruinbase.
  * 
  */
 class BTreeIndex {
  public:
+  static const int BULK_FILL_PERCENT = 90;     // node fill factor of bulk loading
+  static const int BULK_RUN_ENTRIES = 1 << 20; // # pairs sorted in memory per run
+
   BTreeIndex();
   void printTree();
 
   /**
    * Open the index file in read or write mode.
    * Under 'w' mode, the index file should be created if it does not exist.
+   * Under 'm' mode, the index file is memory-mapped for reading.
    * @param indexname[IN] the name of the index file
-   * @param mode[IN] 'r' for read, 'w' for write
+   * @param mode[IN] 'r' for read, 'w' for write, 'm' for memory-mapped read
    * @return error code. 0 if no error
    */
   RC open(const std::string& indexname, char mode);
@@ -71,6 +88,13 @@ class BTreeIndex {
    * code RC_NO_SUCH_RECORD.
    * Using the returned "IndexCursor", you will have to call readForward()
    * to retrieve the actual (key, rid) pair from the index.
+   * Entries with the key of a separator may sit on both sides of it, so
+   * the search descends left of a separator equal to searchKey. If all
+   * keys of that leaf are smaller, the cursor points to the first entry
+   * of the next leaf.
+   * The search starts at the lowest node of the path of the last search
+   * whose key range has searchKey, so searching keys in ascending order
+   * mostly reads only the leaf.
    * @param key[IN] the key to find
    * @param cursor[OUT] the cursor pointing to the index entry with 
    *                    searchKey or immediately behind the largest key 
@@ -88,16 +112,81 @@ class BTreeIndex {
    * @return error code. 0 if no error
    */
   RC readForward(IndexCursor& cursor, int& key, RecordId& rid);
+
+  /**
+   * Find the last index entry whose key is not greater than searchKey.
+   * Only the nodes on the path from the root to a single leaf are read,
+   * so the largest key of the index is found in O(height) page reads.
+   * @param searchKey[IN] the largest key of interest
+   * @param key[OUT] the key of the entry found
+   * @param rid[OUT] the RecordId of the entry found
+   * @return 0 if an entry is found. RC_NO_SUCH_RECORD if every key is
+   *         greater than searchKey, RC_END_OF_TREE if the index is empty
+   */
+  RC locateLast(int searchKey, int& key, RecordId& rid);
+
+  /**
+   * Start building an empty index bottom-up. The (key, RecordId) pairs
+   * are passed to bulkInsert() in any order and the tree is written by
+   * endBulkLoad(), which writes every node page exactly once. The nodes
+   * are packed BULK_FILL_PERCENT full.
+   * @return error code. RC_INVALID_ATTRIBUTE if the index is not empty
+   *         or was not opened in 'w' mode
+   */
+  RC beginBulkLoad();
+
+  /**
+   * Add a (key, RecordId) pair to the index being bulk loaded.
+   * The pairs are sorted in memory and spilled to sorted run files
+   * in the temporary directory once BULK_RUN_ENTRIES pairs are buffered.
+   * @param key[IN] the key for the value inserted into the index
+   * @param rid[IN] the RecordId for the record being inserted into the index
+   * @return error code. 0 if no error
+   */
+  RC bulkInsert(int key, const RecordId& rid);
+
+  /**
+   * Sort (and merge) all pairs passed to bulkInsert() and build the
+   * packed leaf level and the nonleaf levels on top of it.
+   * @return error code. 0 if no error
+   */
+  RC endBulkLoad();
+
+  /**
+   * @return the number of (key, RecordId) pairs stored in the index
+   */
+  int getKeyCount() const { return keyCount; }
   
  private:
   PageFile pf;         /// the PageFile used to store the actual b+tree in disk
 
   PageId   rootPid;    /// the PageId of the root node
   int      treeHeight; /// the height of the tree
-  /// Note that the content of the above two variables will be gone when
-  /// this class is destructed. Make sure to store the values of the two 
-  /// variables in disk, so that they can be reconstructed when the index
-  /// is opened again later.
+  int      keyCount;   /// the number of entries in the tree
+  bool     writable;   /// true if the index was opened in 'w' mode
+  /// The above tree metadata is kept in the header page (page 0) of the
+  /// index file. open() reads it from the header page and close() writes
+  /// it back if the index was opened for writing.
+
+  RC readMetadata();
+  RC writeMetadata();
+
+  /// A node on the path from the root to the leaf of the last locate()
+  typedef struct {
+    PageId    pid;
+    long long low;   /// the keys sent to the node are larger than low
+    long long high;  /// the largest key sent to the node
+  } PathNode;
+  std::vector<PathNode> path; /// the path of the last locate(), from the root down
+
+  std::string indexName;   /// the name of the index file
+  bool     bulkLoading;    /// true between beginBulkLoad() and endBulkLoad()
+  std::vector<IndexEntry> bulkEntries; /// the pairs buffered in memory
+  std::vector<std::pair<std::string, int> > bulkRuns; /// the name and # pairs of each spilled run file
+
+  RC spillRun();
+  RC buildLeafLevel(IndexEntrySource& source, std::vector<std::pair<int, PageId> >& parents);
+  RC buildNonLeafLevel(const std::vector<std::pair<int, PageId> >& children, std::vector<std::pair<int, PageId> >& parents);
   RC insertHelper(int key, const RecordId& rid, int level, PageId currPage, int& keyLocator, PageId &pageLocator);
   RC locateHelper(int searchKey, IndexCursor &cursor, int level, PageId pid_looper);
 };
@@ -1,20 +1,39 @@
 #include "BTreeNode.h"
 #include <cstring>
+#include <climits>
 #include <stdlib.h>
 #include <iostream>
 
 using namespace std;
 
-BTLeafNode::BTLeafNode()
+BTLeafNode::BTLeafNode(int pageSize)
 {
 	//define some constants that will be used to run through the leaf
 	size_of_element = sizeof(int) + sizeof(RecordId);
 	size_of_pageID = sizeof(PageId);
-	size_of_page = PageFile::PAGE_SIZE;
+	size_of_page = pageSize;
 	numKeys = 0;
 
 	//set buffer to 0s
 	memset(buffer, 0, size_of_page);
+	data = buffer;
+	pinnedFile = NULL;
+	pinnedPid = -1;
+}
+
+BTLeafNode::~BTLeafNode()
+{
+	unpin();
+}
+
+/*
+ * Release the page pinned by view(), if there is one.
+ */
+void BTLeafNode::unpin()
+{
+	if (pinnedFile != NULL) pinnedFile->unpin(pinnedPid);
+	pinnedFile = NULL;
+	data = buffer;
 }
 
 void BTLeafNode::setNumKeys(int nKeys)
@@ -30,14 +49,41 @@ void BTLeafNode::setNumKeys(int nKeys)
  */
 RC BTLeafNode::read(PageId pid, const PageFile& pf)
 {
+	unpin();
+
 	//using PageFile API to read the page into the buffer
 	int err = pf.read(pid, buffer); 
 	if (err != 0) return err;
+	size_of_page = pf.getPageSize();
 
 	memcpy(&numKeys, buffer, sizeof(int));
 	return 0;
 
 }
+
+/*
+ * Access the node in the page pid of the PageFile pf in place.
+ * @param pid[IN] the PageId to access
+ * @param pf[IN] PageFile to access
+ * @return 0 if successful. Return an error code if there is an error.
+ */
+RC BTLeafNode::view(PageId pid, const PageFile& pf)
+{
+	unpin();
+
+	//pin the page in the buffer pool and use it without a copy
+	const char* page;
+	int err = pf.pin(pid, page);
+	if (err != 0) return err;
+
+	data = page;
+	pinnedFile = &pf;
+	pinnedPid = pid;
+	size_of_page = pf.getPageSize();
+
+	memcpy(&numKeys, data, sizeof(int));
+	return 0;
+}
 /*
  * Write the content of the node to the page pid in the PageFile pf.
  * @param pid[IN] the PageId to write to
@@ -47,6 +93,9 @@ RC BTLeafNode::read(PageId pid, const PageFile& pf)
 
 RC BTLeafNode::write(PageId pid, PageFile& pf)
 {	
+	//the layout of the node depends on the page size
+	if (pf.getPageSize() != size_of_page) return RC_INVALID_FILE_FORMAT;
+
 	//using the PageFile to write into the page from the buffer 
 	memcpy(buffer, &numKeys, sizeof(int));
 	return pf.write(pid, buffer); 
@@ -61,6 +110,16 @@ int BTLeafNode::getKeyCount()
 	return numKeys;
 }
 
+/*
+ * Return the maximum number of keys that fit in the node.
+ * @return the capacity of the node
+ */
+int BTLeafNode::getMaxKeyCount()
+{
+	//the page holds the key count, the entries and the next node pointer
+	return (size_of_page - sizeof(int) - size_of_pageID) / size_of_element;
+}
+
 /*
  * Insert a (key, rid) pair to the node.
  * @param key[IN] the key to insert
@@ -83,17 +142,15 @@ RC BTLeafNode::insert(int key, const RecordId& rid){
 		byteOffset += size_of_element;
 	}
 
-	//create temp set of memory for the new buffer
-	char temp_buffer[size_of_page];
-
-	//add stuff from buffer that stays the same
-	memcpy(temp_buffer, buffer, byteOffset);
-	memcpy(temp_buffer + byteOffset, &key, sizeof(int));
-	memcpy(temp_buffer + byteOffset + sizeof(int), &rid, sizeof(RecordId));
-	memcpy(temp_buffer + byteOffset + size_of_element, buffer + byteOffset, size_of_page-byteOffset);
+	//shift the entries behind the insertion point by one element.
+	//only the used part of the page moves so that the next node
+	//pointer stored at the end of the page stays where it is
+	int usedBytes = sizeof(int) + numKeys * size_of_element;
+	memmove(buffer + byteOffset + size_of_element, buffer + byteOffset, usedBytes - byteOffset);
 
-	//now recopy the temp buffer back into the buffer:
-	memcpy(buffer, temp_buffer, size_of_page);
+	//add the new entry in the gap
+	memcpy(buffer + byteOffset, &key, sizeof(int));
+	memcpy(buffer + byteOffset + sizeof(int), &rid, sizeof(RecordId));
 
 	numKeys++;
 	return 0;
@@ -129,12 +186,13 @@ RC BTLeafNode::insertAndSplit(int key, const RecordId& rid,
 	int numKeysInSecond;
 	bool insertFirstHalf = false;
 
-	if (index >= numKeys/2){
+	//the new key goes to the half that covers its position, so that
+	//every key in this node stays smaller than the keys in the sibling
+	numKeysInFirst = numKeys/2;
+	if (index >= numKeysInFirst){
 		insertFirstHalf = false;
-		numKeysInFirst = numKeys/2 + 1;
 	}else{
 		insertFirstHalf = true;
-		numKeysInFirst = numKeys/2;
 	}
 	numKeysInSecond = numKeys - numKeysInFirst;
 
@@ -145,7 +203,7 @@ RC BTLeafNode::insertAndSplit(int key, const RecordId& rid,
 	memcpy(sibling.buffer + sizeof(int), buffer + sizeof(int) + (numKeysInFirst * size_of_element), numKeysInSecond * size_of_element);
 	
 
-	memset(buffer + sizeof(int) + (numKeysInFirst * size_of_element), 0, (numKeysInSecond * size_of_element) - sizeof(PageId));
+	memset(buffer + sizeof(int) + (numKeysInFirst * size_of_element), 0, numKeysInSecond * size_of_element);
 
 
 	setNumKeys(numKeysInFirst);
@@ -184,7 +242,7 @@ RC BTLeafNode::locate(int searchKey, int& eid)
 	} 
 	int leafKey = 0;
 	for (int i = 0; i < numKeys; i++){
-		memcpy(&leafKey, buffer + sizeof(int) + (i*size_of_element), sizeof(int));
+		memcpy(&leafKey, data + sizeof(int) + (i*size_of_element), sizeof(int));
 		if (leafKey == searchKey){
 			eid = i;
 			return 0;
@@ -210,8 +268,8 @@ RC BTLeafNode::readEntry(int eid, int& key, RecordId& rid)
 	if (eid < 0 || eid >= numKeys){
 		return RC_NO_SUCH_RECORD;
 	}
-	memcpy(&key, buffer + sizeof(int) + (eid * size_of_element), sizeof(int));
-	memcpy(&rid, buffer + sizeof(int) + (eid * size_of_element) + sizeof(int), sizeof(RecordId));
+	memcpy(&key, data + sizeof(int) + (eid * size_of_element), sizeof(int));
+	memcpy(&rid, data + sizeof(int) + (eid * size_of_element) + sizeof(int), sizeof(RecordId));
 	return 0; 
 }
 
@@ -222,7 +280,7 @@ RC BTLeafNode::readEntry(int eid, int& key, RecordId& rid)
 PageId BTLeafNode::getNextNodePtr()
 { 
 	PageId pid;
-	memcpy (&pid, buffer + (size_of_page - size_of_pageID), size_of_pageID);
+	memcpy (&pid, data + (size_of_page - size_of_pageID), size_of_pageID);
 	return pid; 
 }
 
@@ -247,8 +305,8 @@ void BTLeafNode::printLeaf()
 	{
 		int key;
 		RecordId rid;
-		memcpy(&key, buffer + sizeof(int) + (i * size_of_element), sizeof(int));
-		memcpy(&rid, buffer + (2*sizeof(int)) + (i * size_of_element), sizeof(RecordId));
+		memcpy(&key, data + sizeof(int) + (i * size_of_element), sizeof(int));
+		memcpy(&rid, data + (2*sizeof(int)) + (i * size_of_element), sizeof(RecordId));
 
 		cout << "Key: " << key << " ";
 
@@ -266,8 +324,25 @@ void BTLeafNode::printSize()
 **************************************************************************
 ***************************************************************************/
 
-BTNonLeafNode::BTNonLeafNode() {
+BTNonLeafNode::BTNonLeafNode(int pageSize) {
+	size_of_page = pageSize;
 	numKeys=0;
+	data = buffer;
+	pinnedFile = NULL;
+	pinnedPid = -1;
+}
+
+BTNonLeafNode::~BTNonLeafNode() {
+	unpin();
+}
+
+/*
+ * Release the page pinned by view(), if there is one.
+ */
+void BTNonLeafNode::unpin() {
+	if (pinnedFile != NULL) pinnedFile->unpin(pinnedPid);
+	pinnedFile = NULL;
+	data = buffer;
 }
 
 
@@ -278,11 +353,39 @@ BTNonLeafNode::BTNonLeafNode() {
  * @return 0 if successful. Return an error code if there is an error.
  */
 RC BTNonLeafNode::read(PageId pid, const PageFile& pf){
-	int err = pf.read(pid,buffer); //Using PageFile function to read from specific page
+	unpin();
+
+	//nonleaf nodes are visited by every lookup, so the buffer pool
+	//should keep them resident
+	int err = pf.read(pid,buffer,true); //Using PageFile function to read from specific page
 	if (err != 0) return err;
+	size_of_page = pf.getPageSize();
 	memcpy (&numKeys, buffer + 4, sizeof(int));
 	return 0;
 }
+
+/*
+ * Access the node in the page pid of the PageFile pf in place.
+ * @param pid[IN] the PageId to access
+ * @param pf[IN] PageFile to access
+ * @return 0 if successful. Return an error code if there is an error.
+ */
+RC BTNonLeafNode::view(PageId pid, const PageFile& pf){
+	unpin();
+
+	//pin the page in the buffer pool and use it without a copy
+	const char* page;
+	int err = pf.pin(pid,page,true);
+	if (err != 0) return err;
+
+	data = page;
+	pinnedFile = &pf;
+	pinnedPid = pid;
+	size_of_page = pf.getPageSize();
+
+	memcpy (&numKeys, data + 4, sizeof(int));
+	return 0;
+}
     
 /*
  * Write the content of the node to the page pid in the PageFile pf.
@@ -291,6 +394,7 @@ RC BTNonLeafNode::read(PageId pid, const PageFile& pf){
  * @return 0 if successful. Return an error code if there is an error.
  */
 RC BTNonLeafNode::write(PageId pid, PageFile& pf){
+	if (pf.getPageSize() != size_of_page) return RC_INVALID_FILE_FORMAT;
 	memcpy(buffer+4, &numKeys, sizeof(int));
 	return pf.write(pid,buffer); //Using PageFile function to write to specific page
 }
@@ -303,6 +407,16 @@ int BTNonLeafNode::getKeyCount() {
 	return numKeys;
 }
 
+/*
+ * Return the maximum number of keys that fit in the node.
+ * @return the capacity of the node
+ */
+int BTNonLeafNode::getMaxKeyCount() {
+	//the page holds the first child pointer, the key count and the
+	//(key, pid) pairs
+	return (size_of_page - sizeof(PageId) - sizeof(int)) / (sizeof(int) + sizeof(PageId));
+}
+
 /*
  * Insert a (key, pid) pair to the node.
  * @param key[IN] the key to insert
@@ -314,7 +428,7 @@ RC BTNonLeafNode::insert(int key, PageId pid){
 	//Will be represented by the variable size
 	//Want to see how many of these pairs can fit in buffer
 	int size = sizeof(PageId) + sizeof(int);
-	int pageSize = PageFile::PAGE_SIZE;
+	int pageSize = size_of_page;
 	//max number of pairs that can fit 
 	int max = (pageSize-sizeof(PageId))/size;
 	int currTotal = getKeyCount();
@@ -329,7 +443,7 @@ RC BTNonLeafNode::insert(int key, PageId pid){
 	int currKey;
 	for (int i = 0; i < getKeyCount(); i++){
 		memcpy(&currKey,pointer,sizeof(int));
-		if(currKey==0 || currKey>key) {break;}
+		if(currKey>key) {break;}
 		pointer = pointer + size; //pointer moves smh 
 		count += size;
 	}
@@ -382,7 +496,7 @@ RC BTNonLeafNode::insert(int key, PageId pid){
  */
 RC BTNonLeafNode::insertAndSplit(int key, PageId pid, BTNonLeafNode& sibling, int& midKey){
 	int size = sizeof(PageId) + sizeof(int);
-	int pageSize = PageFile::PAGE_SIZE;
+	int pageSize = size_of_page;
 	//max number of pairs that can fit 
 	int max = (pageSize-sizeof(PageId))/size;
 
@@ -480,32 +594,62 @@ RC BTNonLeafNode::insertAndSplit(int key, PageId pid, BTNonLeafNode& sibling, in
 RC BTNonLeafNode::locateChildPtr(int searchKey, PageId& pid){
 	int size = sizeof(PageId) + sizeof(int);
 
-	char* pointer = buffer + 8;
+	const char* pointer = data + 8;
 
 	//What we will be doing is looping until we find the 
-	//first child noe pointer to follow and output 
-	//it in the pid
+	//first key larger than the searchKey and follow the
+	//child pointer right in front of it
 
-	int total = getKeyCount()*size+8;
-	int count = 8;
 	int curr_key;
 
-	while(count < total) {
+	for (int i = 0; i < getKeyCount(); i++) {
 		memcpy(&curr_key,pointer,sizeof(int));
-		if(curr_key > searchKey && count==8) {
-			memcpy(&pid,buffer,sizeof(PageId));
+		if(curr_key > searchKey) {
+			if (i == 0) memcpy(&pid,data,sizeof(PageId));
+			else memcpy(&pid,pointer - 4,sizeof(PageId));
 			return 0;
 		}
-		else if(curr_key > searchKey) {
-			memcpy(&pid,pointer - 4,sizeof(PageId));
+		pointer = pointer + size;
+	}
+	memcpy(&pid, pointer-4, sizeof(PageId));
+	return 0;
+}
+
+/*
+ * Given the searchKey, find the leftmost child-node pointer that may lead
+ * to an entry with searchKey, and the range of keys this node sends to it.
+ * @param searchKey[IN] the searchKey that is being looked up.
+ * @param pid[OUT] the pointer to the child node to follow.
+ * @param low[OUT] the keys sent to the child are larger (INT_MIN - 1 for the first child).
+ * @param high[OUT] the largest key sent to the child (INT_MAX for the last child).
+ * @return 0 if successful. Return an error code if there is an error.
+ */
+RC BTNonLeafNode::locateFirstChildPtr(int searchKey, PageId& pid, long long& low, long long& high){
+	int size = sizeof(PageId) + sizeof(int);
+
+	const char* pointer = data + 8;
+
+	//A split may leave entries with the key of a separator on both
+	//sides of it, so we follow the child pointer in front of the
+	//first key not smaller than the searchKey. The child gets the
+	//keys after the key before that pointer up to that key
+
+	int curr_key;
+
+	low = (long long)INT_MIN - 1;
+	for (int i = 0; i < getKeyCount(); i++) {
+		memcpy(&curr_key,pointer,sizeof(int));
+		if(curr_key >= searchKey) {
+			if (i == 0) memcpy(&pid,data,sizeof(PageId));
+			else memcpy(&pid,pointer - 4,sizeof(PageId));
+			high = curr_key;
 			return 0;
 		}
-		count = count + 8;
+		low = curr_key;
+		pointer = pointer + size;
 	}
-	//If that doesn't work, then we know that the search key 
-	//is larger than the values of curr_key
-
 	memcpy(&pid, pointer-4, sizeof(PageId));
+	high = INT_MAX;
 	return 0;
 }
 
@@ -538,7 +682,7 @@ void BTNonLeafNode::printNonLeafNode()
 	for (int i = 0; i < getKeyCount(); i++){
 		int key; 
 
-		memcpy(&key, buffer + 8 + (i*(sizeof(PageId)+sizeof(int))),sizeof(int));
+		memcpy(&key, data + 8 + (i*(sizeof(PageId)+sizeof(int))),sizeof(int));
 		cout << "Key: " << key << " ";
 
 	}
@@ -18,7 +18,13 @@
  */
 class BTLeafNode {
   public:
-    BTLeafNode();
+   /**
+    * Create an empty node for a page of pageSize bytes.
+    * read() and view() take over the page size of the PageFile.
+    * @param pageSize[IN] the page size of the index file
+    */
+    BTLeafNode(int pageSize = PageFile::PAGE_SIZE);
+    ~BTLeafNode();
     void printLeaf();
     void printSize();
     void printNextNodePtr();
@@ -86,6 +92,12 @@ class BTLeafNode {
     * @return the number of keys in the node
     */
     int getKeyCount();
+
+   /**
+    * Return the maximum number of keys that fit in the node.
+    * @return the capacity of the node
+    */
+    int getMaxKeyCount();
  
    /**
     * Read the content of the node from the page pid in the PageFile pf.
@@ -94,9 +106,22 @@ class BTLeafNode {
     * @return 0 if successful. Return an error code if there is an error.
     */
     RC read(PageId pid, const PageFile& pf);
+
+   /**
+    * Access the node in the page pid of the PageFile pf in place.
+    * The page is pinned in the buffer pool instead of being copied,
+    * so the node can only be searched and read, not modified.
+    * The page is unpinned by the next read() or view(), or when the
+    * node goes away.
+    * @param pid[IN] the PageId to access
+    * @param pf[IN] PageFile to access
+    * @return 0 if successful. Return an error code if there is an error.
+    */
+    RC view(PageId pid, const PageFile& pf);
     
    /**
     * Write the content of the node to the page pid in the PageFile pf.
+    * The page size of pf has to be the page size of the node.
     * @param pid[IN] the PageId to write to
     * @param pf[IN] PageFile to write to
     * @return 0 if successful. Return an error code if there is an error.
@@ -108,7 +133,16 @@ class BTLeafNode {
     * The main memory buffer for loading the content of the disk page 
     * that contains the node.
     */
-    char buffer[PageFile::PAGE_SIZE];
+    char buffer[PageFile::MAX_PAGE_SIZE];
+
+   /**
+    * The content of the node: either buffer or the page pinned by view().
+    */
+    const char* data;
+    const PageFile* pinnedFile;
+    PageId pinnedPid;
+    void unpin();
+
     int size_of_element;
     int size_of_pageID;
     int size_of_page;
@@ -121,8 +155,15 @@ class BTLeafNode {
  */
 class BTNonLeafNode {
   public:
-    char buffer[PageFile::PAGE_SIZE];
-    BTNonLeafNode();
+    char buffer[PageFile::MAX_PAGE_SIZE];
+
+   /**
+    * Create an empty node for a page of pageSize bytes.
+    * read() and view() take over the page size of the PageFile.
+    * @param pageSize[IN] the page size of the index file
+    */
+    BTNonLeafNode(int pageSize = PageFile::PAGE_SIZE);
+    ~BTNonLeafNode();
     void printNonLeafNode();
    /**
     * Insert a (key, pid) pair to the node.
@@ -157,6 +198,20 @@ class BTNonLeafNode {
     */
     RC locateChildPtr(int searchKey, PageId& pid);
 
+   /**
+    * Given the searchKey, find the leftmost child-node pointer that may
+    * lead to an entry with searchKey, and the range of keys that this node
+    * sends to that child. A split may leave entries with the key of a
+    * separator in the child on its left, so the entries with searchKey
+    * start in that child or in a leaf after it.
+    * @param searchKey[IN] the searchKey that is being looked up.
+    * @param pid[OUT] the pointer to the child node to follow.
+    * @param low[OUT] the keys sent to the child are larger (INT_MIN - 1 for the first child).
+    * @param high[OUT] the largest key sent to the child (INT_MAX for the last child).
+    * @return 0 if successful. Return an error code if there is an error.
+    */
+    RC locateFirstChildPtr(int searchKey, PageId& pid, long long& low, long long& high);
+
    /**
     * Initialize the root node with (pid1, key, pid2).
     * @param pid1[IN] the first PageId to insert
@@ -172,6 +227,12 @@ class BTNonLeafNode {
     */
     int getKeyCount();
 
+   /**
+    * Return the maximum number of keys that fit in the node.
+    * @return the capacity of the node
+    */
+    int getMaxKeyCount();
+
    /**
     * Read the content of the node from the page pid in the PageFile pf.
     * @param pid[IN] the PageId to read
@@ -179,9 +240,22 @@ class BTNonLeafNode {
     * @return 0 if successful. Return an error code if there is an error.
     */
     RC read(PageId pid, const PageFile& pf);
+
+   /**
+    * Access the node in the page pid of the PageFile pf in place.
+    * The page is pinned in the buffer pool instead of being copied,
+    * so the node can only be searched, not modified.
+    * The page is unpinned by the next read() or view(), or when the
+    * node goes away.
+    * @param pid[IN] the PageId to access
+    * @param pf[IN] PageFile to access
+    * @return 0 if successful. Return an error code if there is an error.
+    */
+    RC view(PageId pid, const PageFile& pf);
     
    /**
     * Write the content of the node to the page pid in the PageFile pf.
+    * The page size of pf has to be the page size of the node.
     * @param pid[IN] the PageId to write to
     * @param pf[IN] PageFile to write to
     * @return 0 if successful. Return an error code if there is an error.
@@ -190,9 +264,14 @@ class BTNonLeafNode {
 
   private:
    /**
-    * The main memory buffer for loading the content of the disk page 
-    * that contains the node.
+    * The content of the node: either buffer or the page pinned by view().
     */
+    const char* data;
+    const PageFile* pinnedFile;
+    PageId pinnedPid;
+    void unpin();
+
+    int size_of_page;
     int numKeys;
 }; 
 
@@ -0,0 +1,557 @@
+/*
+ * BufferPool: the page cache shared by all PageFiles of the process.
+ */
+
+#include "BufferPool.h"
+#include "AsyncIO.h"
+#include <cstdlib>
+#include <cstring>
+#include <climits>
+#include <sys/uio.h>
+#include <unistd.h>
+
+using std::map;
+using std::pair;
+using std::vector;
+
+int   BufferPool::frameCount = 0;
+int   BufferPool::frameSize = PageFile::PAGE_SIZE;
+BufferPool::Frame* BufferPool::frames = NULL;
+char* BufferPool::data = NULL;
+int*  BufferPool::buckets = NULL;
+int   BufferPool::bucketMask = 0;
+int   BufferPool::clockHand = 0;
+int   BufferPool::lastFrame = -1;
+
+vector<BufferPool::FileInfo> BufferPool::files;
+map<pair<dev_t, ino_t>, int> BufferPool::fileIds;
+vector<int> BufferPool::freeIds;
+
+pthread_mutex_t BufferPool::latch = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t  BufferPool::changed = PTHREAD_COND_INITIALIZER;
+
+int BufferPool::hitCount = 0;
+int BufferPool::missCount = 0;
+int BufferPool::evictionCount = 0;
+int BufferPool::flushCount = 0;
+
+// the maximum # pages written by a single pwritev() call
+static const int MAX_WRITE_RUN = 256;
+
+// modification time of a file in nanoseconds
+static long mtimeOf(const struct stat& st)
+{
+  return (long)st.st_mtim.tv_sec * 1000000000L + st.st_mtim.tv_nsec;
+}
+
+void BufferPool::init()
+{
+  if (frames == NULL) resize(DEFAULT_POOL_SIZE, frameSize);
+}
+
+RC BufferPool::setPoolSize(size_t bytes)
+{
+  lock();
+  RC rc = resize(bytes, frameSize);
+  unlock();
+  return rc;
+}
+
+RC BufferPool::resize(size_t bytes, int newFrameSize)
+{
+  if (bytes / newFrameSize > (size_t)MAX_FRAME_COUNT) return RC_INVALID_ATTRIBUTE;
+
+  // the frames of asynchronous reads must not go away under the kernel
+  AsyncIO::wait();
+
+  // write back the dirty pages before their frames go away. the latch
+  // is released during a write, so the frames are checked from the
+  // start again after it
+  for (int i = 0; i < frameCount; i++) {
+    if (frames[i].fileId >= 0 && frames[i].pins > 0) return RC_INVALID_ATTRIBUTE;
+    if (frames[i].fileId >= 0 && frames[i].dirty) {
+      RC rc = writeRun(i);
+      if (rc < 0) return rc;
+      i = -1;
+    }
+  }
+
+  int    count = bytes / newFrameSize;
+  if (count < MIN_FRAME_COUNT) count = MIN_FRAME_COUNT;
+  Frame* newFrames = (Frame*)malloc(count * sizeof(Frame));
+  char*  newData = (char*)malloc((size_t)count * newFrameSize);
+
+  // use twice as many hash buckets as frames to keep the chains short
+  int bucketCount = 1;
+  while (bucketCount < 2 * count) bucketCount <<= 1;
+  int* newBuckets = (int*)malloc(bucketCount * sizeof(int));
+
+  if (newFrames == NULL || newData == NULL || newBuckets == NULL) {
+    free(newFrames);
+    free(newData);
+    free(newBuckets);
+    return RC_OUT_OF_MEMORY;
+  }
+
+  free(frames);
+  free(data);
+  free(buckets);
+
+  frames = newFrames;
+  data = newData;
+  buckets = newBuckets;
+  frameCount = count;
+  frameSize = newFrameSize;
+  bucketMask = bucketCount - 1;
+  clockHand = 0;
+  lastFrame = -1;
+
+  for (int i = 0; i < frameCount; i++) {
+    frames[i].fileId = -1;
+    frames[i].usage = 0;
+    frames[i].dirty = false;
+    frames[i].pins = 0;
+    frames[i].loading = false;
+    frames[i].writing = false;
+    frames[i].next = -1;
+  }
+  for (int i = 0; i < bucketCount; i++) buckets[i] = -1;
+
+  return 0;
+}
+
+int BufferPool::openFile(const struct stat& st, int fd, int pageSize, off_t base)
+{
+  init();
+
+  // the pages of the file have to fit in the frames
+  if (pageSize > frameSize && resize(getPoolSize(), pageSize) < 0) return -1;
+
+  // is the file already known to the pool?
+  pair<dev_t, ino_t> key(st.st_dev, st.st_ino);
+  map<pair<dev_t, ino_t>, int>::iterator it = fileIds.find(key);
+  if (it != fileIds.end()) {
+    int i = it->second;
+
+    // the file was modified (or deleted and recreated) since its pages
+    // were cached. the cached pages are stale. while the file is open,
+    // all changes go through the pool, so the pages are always valid.
+    if (files[i].opens == 0 &&
+        (files[i].size != st.st_size || files[i].mtime != mtimeOf(st))) {
+      dropFile(i);
+    }
+    files[i].opens++;
+    if (fd >= 0) files[i].fd = fd;
+    files[i].pageSize = pageSize;
+    files[i].base = base;
+    return i;
+  }
+
+  FileInfo info;
+  info.dev = st.st_dev;
+  info.ino = st.st_ino;
+  info.size = st.st_size;
+  info.mtime = mtimeOf(st);
+  info.opens = 1;
+  info.fd = fd;
+  info.pageSize = pageSize;
+  info.base = base;
+
+  // take the id of a removed file if there is one
+  int i;
+  if (!freeIds.empty()) {
+    i = freeIds.back();
+    freeIds.pop_back();
+    files[i] = info;
+  } else {
+    i = files.size();
+    files.push_back(info);
+  }
+  fileIds[key] = i;
+
+  return i;
+}
+
+void BufferPool::closeFile(int fileId, const struct stat& st, int fd)
+{
+  if (fileId < 0 || fileId >= (int)files.size()) return;
+
+  files[fileId].size = st.st_size;
+  files[fileId].mtime = mtimeOf(st);
+  files[fileId].opens--;
+  if (files[fileId].fd == fd) files[fileId].fd = -1;
+}
+
+void BufferPool::removeFile(const struct stat& st)
+{
+  // no read or write may still use a frame of the file
+  if (AsyncIO::getPendingCount() > 0) AsyncIO::wait();
+
+  map<pair<dev_t, ino_t>, int>::iterator it = fileIds.find(pair<dev_t, ino_t>(st.st_dev, st.st_ino));
+  if (it == fileIds.end()) return;
+
+  int i = it->second;
+  if (files[i].opens > 0) return;
+
+  dropFile(i);
+
+  fileIds.erase(it);
+  files[i].fd = -1;
+  freeIds.push_back(i);
+}
+
+RC BufferPool::flushFile(int fileId)
+{
+  struct Run {
+    PageId first;
+    int    n;
+    int    run[MAX_WRITE_RUN];
+    struct iovec iov[MAX_WRITE_RUN];
+  };
+  vector<Run*> runs;
+  int    fd = (fileId >= 0 && fileId < (int)files.size()) ? files[fileId].fd : -1;
+  RC     rc = 0;
+
+  // collect all runs of dirty pages of the file. the pages of a run
+  // are marked clean right away, so that they are not collected again
+  for (int i = 0; i < frameCount; i++) {
+    if (frames[i].fileId == fileId && frames[i].dirty) {
+      if (fd < 0) return RC_FILE_WRITE_FAILED;
+
+      // the pages are pinned, since the latch is released while
+      // AsyncIO waits for the writes
+      Run* r = new Run;
+      r->n = collectRun(i, r->first, r->run, r->iov);
+      for (int j = 0; j < r->n; j++) {
+        frames[r->run[j]].dirty = false;
+        frames[r->run[j]].writing = true;
+        frames[r->run[j]].pins++;
+      }
+      runs.push_back(r);
+    }
+  }
+
+  // the pages written back by other threads must be on the disk, too
+  if (runs.empty()) {
+    waitWrites(fileId);
+    return 0;
+  }
+
+  // write all runs at the same time and wait for them
+  int pages = 0;
+  for (unsigned i = 0; i < runs.size(); i++) {
+    off_t offset = files[fileId].base + (off_t)runs[i]->first * files[fileId].pageSize;
+    if (rc == 0) rc = AsyncIO::queueWrite(fd, offset, runs[i]->iov, runs[i]->n);
+    pages += runs[i]->n;
+  }
+  RC waitRc = AsyncIO::wait();
+  if (rc == 0) rc = waitRc;
+  flushCount += runs.size();
+
+  // the pages stay dirty if they could not be written
+  for (unsigned i = 0; i < runs.size(); i++) {
+    for (int j = 0; j < runs[i]->n; j++) {
+      Frame& f = frames[runs[i]->run[j]];
+      f.writing = false;
+      f.pins--;
+      if (rc < 0) f.dirty = true;
+    }
+    delete runs[i];
+  }
+  wakeUp();
+  waitWrites(fileId);
+  if (rc < 0) return rc;
+
+  PageFile::writeCount += pages;
+  return 0;
+}
+
+void BufferPool::markDirty(int fileId, PageId pid)
+{
+  int i = findFrame(fileId, pid);
+  if (i >= 0) frames[i].dirty = true;
+}
+
+int BufferPool::collectRun(int frame, PageId& first, int* run, struct iovec* iov)
+{
+  int    fileId = frames[frame].fileId;
+  int    n = 0;
+  int    i;
+
+  first = frames[frame].pid;
+
+  // extend the run to the dirty pages right in front of the page ...
+  while (first > 0 && n < MAX_WRITE_RUN / 2 &&
+         (i = findFrame(fileId, first - 1)) >= 0 && frames[i].dirty) {
+    first--;
+    n++;
+  }
+
+  // ... and collect the run of dirty pages starting from there
+  n = 0;
+  while (n < MAX_WRITE_RUN && (i = findFrame(fileId, first + n)) >= 0 && frames[i].dirty) {
+    run[n] = i;
+    iov[n].iov_base = data + (size_t)i * frameSize;
+    iov[n].iov_len = files[fileId].pageSize;
+    n++;
+  }
+
+  return n;
+}
+
+RC BufferPool::writeRun(int frame)
+{
+  int    fileId = frames[frame].fileId;
+  int    fd = files[fileId].fd;
+  int    pageSize = files[fileId].pageSize;
+  int    run[MAX_WRITE_RUN];
+  struct iovec iov[MAX_WRITE_RUN];
+  PageId first;
+  int    i;
+
+  if (fd < 0) return RC_FILE_WRITE_FAILED;
+
+  int n = collectRun(frame, first, run, iov);
+
+  // the pages are pinned and marked clean while the latch is released
+  // for the write. a page modified meanwhile is marked dirty again
+  for (i = 0; i < n; i++) {
+    frames[run[i]].dirty = false;
+    frames[run[i]].writing = true;
+    frames[run[i]].pins++;
+  }
+  unlock();
+
+  // write all pages of the run with a single system call
+  RC      rc = 0;
+  int     calls = 0;
+  off_t   offset = files[fileId].base + (off_t)first * pageSize;
+  ssize_t left = (ssize_t)n * pageSize;
+  struct iovec* v = iov;
+  int     vcnt = n;
+  while (left > 0) {
+    ssize_t written = ::pwritev(fd, v, vcnt, offset);
+    calls++;
+    if (written < 0) {
+      rc = RC_FILE_WRITE_FAILED;
+      break;
+    }
+
+    // continue after a partial write
+    offset += written;
+    left -= written;
+    while (vcnt > 0 && written >= (ssize_t)v->iov_len) {
+      written -= v->iov_len;
+      v++;
+      vcnt--;
+    }
+    if (vcnt > 0) {
+      v->iov_base = (char*)v->iov_base + written;
+      v->iov_len -= written;
+    }
+  }
+
+  lock();
+  for (i = 0; i < n; i++) {
+    frames[run[i]].writing = false;
+    frames[run[i]].pins--;
+    if (rc < 0) frames[run[i]].dirty = true;
+  }
+  flushCount += calls;
+  wakeUp();
+  if (rc < 0) return rc;
+
+  PageFile::writeCount += n;
+  return 0;
+}
+
+void BufferPool::waitWrites(int fileId)
+{
+  // start over after every wait, since the frames may have changed
+  for (int i = 0; i < frameCount; i++) {
+    if (frames[i].fileId == fileId && frames[i].writing) {
+      sleep();
+      i = -1;
+    }
+  }
+}
+
+int BufferPool::hash(int fileId, PageId pid)
+{
+  unsigned h = (unsigned)pid * 2654435761u + (unsigned)fileId * 40503u;
+  return (h ^ (h >> 15)) & bucketMask;
+}
+
+int BufferPool::findFrame(int fileId, PageId pid)
+{
+  for (int i = buckets[hash(fileId, pid)]; i >= 0; i = frames[i].next) {
+    if (frames[i].fileId == fileId && frames[i].pid == pid) return i;
+  }
+  return -1;
+}
+
+void BufferPool::unlinkFrame(int frame)
+{
+  int* link = &buckets[hash(frames[frame].fileId, frames[frame].pid)];
+
+  // remove the frame from its hash chain
+  while (*link != frame) link = &frames[*link].next;
+  *link = frames[frame].next;
+
+  frames[frame].fileId = -1;
+  frames[frame].usage = 0;
+  frames[frame].dirty = false;
+  frames[frame].pins = 0;
+  frames[frame].loading = false;
+  frames[frame].writing = false;
+  frames[frame].next = -1;
+}
+
+char* BufferPool::findPage(int fileId, PageId pid, bool hot)
+{
+  init();
+
+  int i = findFrame(fileId, pid);
+  if (i < 0) {
+    missCount++;
+    return NULL;
+  }
+
+  hitCount++;
+
+  // repeated lookups of the same page in a row (e.g., reading all records
+  // of a page one by one) are a single reference as far as CLOCK goes
+  if (hot) {
+    frames[i].usage = HOT_USAGE;
+  } else if (i != lastFrame && frames[i].usage < MAX_USAGE) {
+    frames[i].usage = MAX_USAGE;
+  }
+  lastFrame = i;
+  return data + (size_t)i * frameSize;
+}
+
+char* BufferPool::peekPage(int fileId, PageId pid)
+{
+  if (frames == NULL) return NULL;
+
+  int i = findFrame(fileId, pid);
+  return (i < 0) ? NULL : data + (size_t)i * frameSize;
+}
+
+char* BufferPool::newPage(int fileId, PageId pid, bool hot)
+{
+  init();
+
+  // CLOCK replacement: sweep the frames, decrementing the usage count,
+  // until we find an empty frame or a frame whose usage count is zero
+  // pinned frames are skipped. if every frame is pinned, we give up
+  // after the hand went around often enough to clear all usage counts
+  int victim;
+  int steps = 0;
+  for (;;) {
+    if (++steps > frameCount * (HOT_USAGE + 2)) return NULL;
+
+    victim = clockHand;
+    clockHand = (clockHand + 1) % frameCount;
+
+    if (frames[victim].fileId < 0) break;
+    if (frames[victim].pins > 0) continue;
+    if (frames[victim].usage == 0) {
+      // write back the page (and its dirty neighbors) before replacing it.
+      // the frame may be used again while the latch is released for the
+      // write, so the hand looks at it once more afterwards
+      if (frames[victim].dirty) {
+        if (writeRun(victim) < 0) return NULL;
+        clockHand = victim;
+        continue;
+      }
+      unlinkFrame(victim);
+      evictionCount++;
+      break;
+    }
+    frames[victim].usage--;
+  }
+
+  // another thread may have cached the page while the latch was released
+  if (findFrame(fileId, pid) >= 0) return NULL;
+
+  // a newly loaded page does not count as referenced yet,
+  // unless it is hot
+  frames[victim].fileId = fileId;
+  frames[victim].pid = pid;
+  frames[victim].usage = hot ? HOT_USAGE : 0;
+  frames[victim].dirty = false;
+  frames[victim].pins = 0;
+  frames[victim].loading = false;
+  frames[victim].writing = false;
+  lastFrame = victim;
+
+  int b = hash(fileId, pid);
+  frames[victim].next = buckets[b];
+  buckets[b] = victim;
+
+  return data + (size_t)victim * frameSize;
+}
+
+void BufferPool::startLoad(int fileId, PageId pid)
+{
+  int i = findFrame(fileId, pid);
+  if (i < 0) return;
+
+  frames[i].loading = true;
+  frames[i].pins++;
+}
+
+void BufferPool::endLoad(int fileId, PageId pid, bool ok, bool ahead)
+{
+  int i = findFrame(fileId, pid);
+  if (i < 0 || !frames[i].loading) return;
+
+  wakeUp();
+  frames[i].loading = false;
+  frames[i].pins--;
+  if (!ok) {
+    unlinkFrame(i);
+    return;
+  }
+  PageFile::readCount++;
+
+  // the page was read because it is about to be used. it must not be
+  // replaced by the next sweep of the clock hand before that happens
+  if (ahead && frames[i].usage < MAX_USAGE) frames[i].usage = MAX_USAGE;
+}
+
+bool BufferPool::isLoading(int fileId, PageId pid)
+{
+  int i = findFrame(fileId, pid);
+  return i >= 0 && frames[i].loading;
+}
+
+void BufferPool::pinPage(int fileId, PageId pid)
+{
+  int i = findFrame(fileId, pid);
+  if (i >= 0) frames[i].pins++;
+}
+
+void BufferPool::unpinPage(int fileId, PageId pid)
+{
+  int i = findFrame(fileId, pid);
+  if (i >= 0 && frames[i].pins > 0) frames[i].pins--;
+}
+
+void BufferPool::dropPage(int fileId, PageId pid)
+{
+  if (frames == NULL) return;
+
+  int i = findFrame(fileId, pid);
+  if (i >= 0) unlinkFrame(i);
+}
+
+void BufferPool::dropFile(int fileId)
+{
+  if (frames == NULL) return;
+
+  for (int i = 0; i < frameCount; i++) {
+    if (frames[i].fileId == fileId) unlinkFrame(i);
+  }
+}
@@ -0,0 +1,304 @@
+/*
+ * BufferPool: the page cache shared by all PageFiles of the process.
+ */
+
+#ifndef BUFFERPOOL_H
+#define BUFFERPOOL_H
+
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <map>
+#include <utility>
+#include <vector>
+#include "Bruinbase.h"
+#include "PageFile.h"
+
+/**
+ * A fixed-size pool of page frames shared by all open PageFiles.
+ * Pages are looked up through a hash table on (file id, page id) and
+ * replaced with the CLOCK policy. A newly loaded page starts with a
+ * clear reference bit, so the pages touched only once by a table scan
+ * are replaced before the pages that are referenced repeatedly.
+ * Back-to-back lookups of the same page count as a single reference.
+ * Pages loaded with the "hot" hint (e.g., b+tree nonleaf nodes) survive
+ * several sweeps of the clock hand.
+ *
+ * All frames have the same size, which is the largest page size of the
+ * files opened so far. When a file with larger pages is opened, the pool
+ * is rebuilt with larger frames of the same total size.
+ *
+ * A file is identified by its device and inode number, so that its pages
+ * stay in the pool after the file is closed and are reused when the file
+ * is opened again by a later query. The pages of a file that is deleted
+ * through removeFile() are dropped, and its file id is reused by the
+ * next file that is opened.
+ *
+ * PageFile::write() only updates the cached page and marks it dirty.
+ * Dirty pages are written back when they are replaced or when their file
+ * is flushed or closed, with adjacent dirty pages of the same file going
+ * out in a single write. When a file is flushed, all of its runs of dirty
+ * pages are handed to AsyncIO together.
+ *
+ * A page is read into the pool in a frame set up with newPage() and
+ * startLoad(). The frame stays pinned until endLoad() is called for it,
+ * by AsyncIO or by the thread that reads the page.
+ *
+ * The pool and AsyncIO are not safe for concurrent use by themselves.
+ * A thread must hold the latch (lock()/unlock()) while it uses them;
+ * PageFile takes it in every function that works with the pool. The
+ * content of a pinned page can be used without the latch.
+ *
+ * The latch is not held during disk I/O. A page is read without it once
+ * its frame is set up, and the other threads that need the page wait
+ * with sleep() until it has arrived. The pages written back are pinned
+ * while the latch is released for the write, so newPage(), flushFile()
+ * and the AsyncIO calls that wait may release the latch for a while.
+ */
+class BufferPool {
+ public:
+  static const int DEFAULT_POOL_SIZE = 4 * 1024 * 1024;  // 4MB by default
+  static const int MIN_FRAME_COUNT = 16;  // the pool has at least 16 frames
+  static const int MAX_FRAME_COUNT = 1 << 28;  // and at most 2^28 frames
+
+  /**
+   * set the size of the buffer pool. all pages cached so far are dropped
+   * after the dirty pages are written back. unlike the other functions,
+   * this one takes the latch by itself.
+   * @param bytes[IN] the memory used for page frames
+   * @return error code. 0 if no error. RC_INVALID_ATTRIBUTE if a page
+   *         is pinned or the pool would have more than MAX_FRAME_COUNT frames
+   */
+  static RC setPoolSize(size_t bytes);
+
+  /**
+   * @return the memory used for page frames in bytes
+   */
+  static size_t getPoolSize() { return (size_t)frameCount * frameSize; }
+
+  /**
+   * register an open file with the buffer pool.
+   * if the file has changed since its pages were cached, the stale
+   * pages are dropped.
+   * @param st[IN] the status of the open file from fstat()
+   * @param fd[IN] the file descriptor used to write back dirty pages.
+   *               -1 if the file is opened read-only
+   * @param pageSize[IN] the page size of the file
+   * @param base[IN] the offset of page 0 in the file
+   * @return the file id used for the pages of the file. -1 if the frames
+   *         cannot be enlarged to pageSize
+   */
+  static int openFile(const struct stat& st, int fd, int pageSize, off_t base);
+
+  /**
+   * unregister a file that is being closed.
+   * all dirty pages of the file must have been flushed already.
+   * the state of the file is recorded, so that openFile() can tell
+   * whether the file was changed in the meantime.
+   * @param fileId[IN] the id returned by openFile()
+   * @param st[IN] the status of the file right before it is closed
+   * @param fd[IN] the file descriptor passed to openFile()
+   */
+  static void closeFile(int fileId, const struct stat& st, int fd);
+
+  /**
+   * forget a file that is being deleted. if no PageFile has the file open,
+   * its cached pages are dropped without writing back the dirty ones,
+   * and its file id is freed for the next file that is opened.
+   * @param st[IN] the status of the file from stat()
+   */
+  static void removeFile(const struct stat& st);
+
+  /**
+   * write all dirty pages of a file back to the disk.
+   * runs of dirty pages with consecutive page ids are written together.
+   * @param fileId[IN] the file to flush
+   * @return error code. 0 if no error
+   */
+  static RC flushFile(int fileId);
+
+  /**
+   * mark a cached page as modified. the page is written back to the disk
+   * when it is replaced or when its file is flushed.
+   * @param fileId[IN] the file of the page
+   * @param pid[IN] the cached page
+   */
+  static void markDirty(int fileId, PageId pid);
+
+  /**
+   * look up a page in the pool.
+   * @param fileId[IN] the file of the page
+   * @param pid[IN] the page to look up
+   * @param hot[IN] true if the page should stay resident longer
+   * @return the frame holding the page. NULL if the page is not cached
+   */
+  static char* findPage(int fileId, PageId pid, bool hot);
+
+  /**
+   * look up a page in the pool without counting it as a reference.
+   * @param fileId[IN] the file of the page
+   * @param pid[IN] the page to look up
+   * @return the frame holding the page. NULL if the page is not cached
+   */
+  static char* peekPage(int fileId, PageId pid);
+
+  /**
+   * get a frame for a page that is not in the pool, replacing a cached
+   * page if necessary. a dirty page is written back before it is replaced.
+   * the caller must fill the frame with the page content
+   * or call dropPage() if it cannot.
+   * @param fileId[IN] the file of the page
+   * @param pid[IN] the page to cache
+   * @param hot[IN] true if the page should stay resident longer
+   * @return the frame for the page. NULL if all frames are pinned,
+   *         a dirty page could not be written back, or another thread
+   *         cached the page while the latch was released for the write
+   */
+  static char* newPage(int fileId, PageId pid, bool hot);
+
+  /**
+   * mark a page returned by newPage() as being read.
+   * the page is pinned until endLoad() is called.
+   * @param fileId[IN] the file of the page
+   * @param pid[IN] the page being read
+   */
+  static void startLoad(int fileId, PageId pid);
+
+  /**
+   * finish the read of a page and wake up the threads waiting for it.
+   * @param fileId[IN] the file of the page
+   * @param pid[IN] the page that was read
+   * @param ok[IN] false if the read failed. the page is dropped then
+   * @param ahead[IN] true if the page was read ahead of its use. it is
+   *                  then kept until the clock hand passes it once more
+   */
+  static void endLoad(int fileId, PageId pid, bool ok, bool ahead = true);
+
+  /**
+   * @return true if the page is still being read
+   */
+  static bool isLoading(int fileId, PageId pid);
+
+  /**
+   * pin a cached page, so that it is not replaced until it is unpinned.
+   * @param fileId[IN] the file of the page
+   * @param pid[IN] the cached page
+   */
+  static void pinPage(int fileId, PageId pid);
+
+  /**
+   * release a pin taken by pinPage().
+   * @param fileId[IN] the file of the page
+   * @param pid[IN] the pinned page
+   */
+  static void unpinPage(int fileId, PageId pid);
+
+  /**
+   * remove a page from the pool.
+   * @param fileId[IN] the file of the page
+   * @param pid[IN] the page to remove
+   */
+  static void dropPage(int fileId, PageId pid);
+
+  /**
+   * acquire the latch that serializes the use of the pool and of AsyncIO
+   * by several threads. the latch is not recursive.
+   */
+  static void lock()   { pthread_mutex_lock(&latch); }
+
+  /**
+   * release the latch acquired by lock().
+   */
+  static void unlock() { pthread_mutex_unlock(&latch); }
+
+  /**
+   * release the latch until another thread finishes a read or a write,
+   * and acquire it again.
+   */
+  static void sleep()  { pthread_cond_wait(&changed, &latch); }
+
+  /**
+   * wake up the threads in sleep(), after a read or a write is finished.
+   */
+  static void wakeUp() { pthread_cond_broadcast(&changed); }
+
+  /**
+   * @return the total # of page lookups that found the page in the pool
+   */
+  static int getHitCount()      { return hitCount; }
+
+  /**
+   * @return the total # of page lookups that did not find the page
+   */
+  static int getMissCount()     { return missCount; }
+
+  /**
+   * @return the total # of cached pages replaced by other pages
+   */
+  static int getEvictionCount() { return evictionCount; }
+
+  /**
+   * @return the total # of write system calls issued to write back pages
+   */
+  static int getFlushCount()    { return flushCount; }
+
+ private:
+  static const int MAX_USAGE = 1;  // usage count of a referenced page
+  static const int HOT_USAGE = 4;  // usage count of a "hot" page
+
+  struct Frame {
+    int    fileId;  // file of the cached page (-1 if the frame is empty)
+    PageId pid;     // the cached page
+    int    usage;   // CLOCK usage count. the frame is replaced at zero
+    bool   dirty;   // true if the page was modified since it was loaded
+    int    pins;    // # users accessing the frame in place. never replaced
+                    // while pinned
+    bool   loading; // true while the page is read
+    bool   writing; // true while the page is written back without the latch
+    int    next;    // next frame in the same hash bucket (-1 at the end)
+  };
+
+  struct FileInfo {
+    dev_t  dev;
+    ino_t  ino;
+    off_t  size;    // the size of the file when it was closed last time
+    long   mtime;   // the modification time (in ns) at that time
+    int    opens;   // # PageFiles that have the file open
+    int    fd;      // the descriptor used to write back dirty pages
+    int    pageSize; // the page size of the file
+    off_t  base;    // the offset of page 0 in the file
+  };
+
+  static void init();
+  static RC   resize(size_t bytes, int newFrameSize);
+  static int  hash(int fileId, PageId pid);
+  static int  findFrame(int fileId, PageId pid);
+  static void unlinkFrame(int frame);
+  static void dropFile(int fileId);
+  static int  collectRun(int frame, PageId& first, int* run, struct iovec* iov);
+  static RC   writeRun(int frame);
+  static void waitWrites(int fileId);
+
+  static int    frameCount;   // # frames in the pool
+  static int    frameSize;    // the size of a frame in bytes
+  static Frame* frames;       // frame descriptors
+  static char*  data;         // frameCount pages of memory
+  static int*   buckets;      // the first frame of every hash bucket
+  static int    bucketMask;   // # buckets - 1
+  static int    clockHand;    // the next frame the CLOCK policy looks at
+  static int    lastFrame;    // the frame returned by the last lookup
+
+  static std::vector<FileInfo> files;  // the files registered with the pool
+  static std::map<std::pair<dev_t, ino_t>, int> fileIds;  // the id of every file in files
+  static std::vector<int> freeIds;     // the ids of the files that were removed
+
+  static pthread_mutex_t latch;  // see lock()
+  static pthread_cond_t  changed; // see sleep()
+
+  static int hitCount;
+  static int missCount;
+  static int evictionCount;
+  static int flushCount;
+};
+
+#endif // BUFFERPOOL_H
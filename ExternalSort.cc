@@ -0,0 +1,304 @@
+/*
+ * ExternalSort: the tuples of an ORDER BY sorted in runs that spill to disk.
+ */
+
+#include "ExternalSort.h"
+#include <algorithm>
+#include <cstring>
+
+using std::string;
+
+// the size of a tuple stored at t
+static int tupleSize(const char* t)
+{
+  return sizeof(int) + strlen(t + sizeof(int)) + 1;
+}
+
+ExternalSort::ExternalSort(bool value, bool desc, const string& name, size_t bytes)
+  : byValue(value), descending(desc), spillName(name), budget(bytes),
+    block(0), blockUsed(ARENA_BLOCK), last(-1), returning(false), merging(false), nextTuple(0)
+{
+}
+
+ExternalSort::~ExternalSort()
+{
+  endMerge();
+  for (unsigned i = 0; i < blocks.size(); i++) delete [] blocks[i];
+
+  // remove the runs that were not merged
+  for (unsigned i = 0; i < runs.size(); i++) PageFile::remove(runs[i]);
+}
+
+int ExternalSort::compare(const char* a, const char* b) const
+{
+  if (byValue) return strcmp(a + sizeof(int), b + sizeof(int));
+
+  int x, y;
+  memcpy(&x, a, sizeof(int));
+  memcpy(&y, b, sizeof(int));
+  return (x < y) ? -1 : (x > y);
+}
+
+bool ExternalSort::Less::operator()(const char* a, const char* b) const
+{
+  int c = sort->compare(a, b);
+  return sort->descending ? c > 0 : c < 0;
+}
+
+RC ExternalSort::add(int key, const char* value)
+{
+  RC rc;
+
+  if (returning) return RC_INVALID_ATTRIBUTE;
+
+  int length = sizeof(int) + strlen(value) + 1;
+  if (blockUsed + length > ARENA_BLOCK) {
+    if (block + 1 < blocks.size()) {
+      block++;
+    } else if (!blocks.empty() &&
+               (blocks.size() + 1) * ARENA_BLOCK + tuples.capacity() * sizeof(char*) > budget) {
+      // the tuples in memory fill the budget. they are written to a run
+      // and the arena is filled again from its first block
+      if ((rc = writeRun()) < 0) return rc;
+    } else {
+      blocks.push_back(new char[ARENA_BLOCK]);
+      block = blocks.size() - 1;
+    }
+    blockUsed = 0;
+  }
+
+  char* t = blocks[block] + blockUsed;
+  memcpy(t, &key, sizeof(int));
+  memcpy(t + sizeof(int), value, length - sizeof(int));
+  blockUsed += length;
+  tuples.push_back(t);
+
+  return 0;
+}
+
+RC ExternalSort::openRun(RunWriter& w)
+{
+  w.pid = 0;
+  w.count = 0;
+  w.used = sizeof(int);
+  return w.pf.openTemp(spillName + ".srt", w.name);
+}
+
+RC ExternalSort::writeTuple(RunWriter& w, const char* tuple)
+{
+  RC  rc;
+  int length = tupleSize(tuple);
+
+  if (w.used + length > w.pf.getPageSize()) {
+    memcpy(w.page, &w.count, sizeof(int));
+    if ((rc = w.pf.write(w.pid++, w.page)) < 0) return rc;
+    w.count = 0;
+    w.used = sizeof(int);
+  }
+  memcpy(w.page + w.used, tuple, length);
+  w.used += length;
+  w.count++;
+
+  return 0;
+}
+
+RC ExternalSort::closeRun(RunWriter& w)
+{
+  RC rc = 0;
+
+  if (w.count > 0) {
+    memcpy(w.page, &w.count, sizeof(int));
+    rc = w.pf.write(w.pid++, w.page);
+  }
+  RC closed = w.pf.close();
+  return (rc < 0) ? rc : closed;
+}
+
+RC ExternalSort::writeRun()
+{
+  RC rc = 0;
+
+  if (tuples.empty()) return 0;
+
+  Less less = { this };
+  std::stable_sort(tuples.begin(), tuples.end(), less);
+
+  RunWriter* w = new RunWriter;
+  if ((rc = openRun(*w)) == 0) {
+    for (unsigned i = 0; i < tuples.size() && rc == 0; i++) rc = writeTuple(*w, tuples[i]);
+    RC closed = closeRun(*w);
+    if (rc == 0) rc = closed;
+  }
+  runs.push_back(w->name);
+  delete w;
+
+  tuples.clear();
+  block = 0;
+  blockUsed = 0;
+  return rc;
+}
+
+RC ExternalSort::advance(RunReader& r)
+{
+  RC rc;
+
+  if (r.left > 0) {
+    r.tuple += tupleSize(r.tuple);
+    r.left--;
+    return 0;
+  }
+
+  // go on with the next page of the run that has a tuple
+  r.tuple = NULL;
+  while (++r.pid < r.pf.endPid()) {
+    if ((rc = r.pf.read(r.pid, r.page)) < 0) return rc;
+
+    int count;
+    memcpy(&count, r.page, sizeof(int));
+    if (count > 0) {
+      r.tuple = r.page + sizeof(int);
+      r.left = count - 1;
+      break;
+    }
+  }
+  return 0;
+}
+
+bool ExternalSort::before(int a, int b) const
+{
+  // the input past the last one comes before all others while the tree
+  // is built. an input at the end of its run comes after all others
+  int n = inputs.size();
+  if (a == n) return true;
+  if (b == n) return false;
+
+  const char* x = inputs[a]->tuple;
+  const char* y = inputs[b]->tuple;
+  if (x == NULL) return false;
+  if (y == NULL) return true;
+
+  // the runs are in the order their tuples were added, so equal
+  // tuples come from the earlier run first
+  int c = compare(x, y);
+  if (c != 0) return descending ? c > 0 : c < 0;
+  return a < b;
+}
+
+void ExternalSort::adjust(int s)
+{
+  // play the input s up to the root. the loser of every match stays
+  // in the node and the winner goes on
+  int n = inputs.size();
+  for (int t = (s + n) / 2; t > 0; t /= 2) {
+    if (before(losers[t], s)) std::swap(s, losers[t]);
+  }
+  losers[0] = s;
+}
+
+RC ExternalSort::startMerge(int n)
+{
+  RC rc = 0;
+
+  for (int i = 0; i < n; i++) {
+    RunReader* r = new RunReader;
+    r->name = runs[i];
+    r->pid = -1;
+    r->left = 0;
+    r->tuple = NULL;
+    inputs.push_back(r);
+
+    if (rc == 0 && (rc = r->pf.open(r->name, 'r')) == 0) {
+      r->pf.advise(PageFile::SEQUENTIAL);
+      rc = advance(*r);
+    }
+  }
+  runs.erase(runs.begin(), runs.begin() + n);
+
+  losers.assign(n, n);
+  for (int i = n - 1; i >= 0; i--) adjust(i);
+  last = -1;
+
+  return rc;
+}
+
+RC ExternalSort::nextMerged(const char*& tuple)
+{
+  RC rc;
+
+  // the input of the last tuple goes on with its next tuple
+  if (last >= 0) {
+    if ((rc = advance(*inputs[last])) < 0) return rc;
+    adjust(last);
+  }
+
+  last = losers[0];
+  if (inputs[last]->tuple == NULL) {
+    last = -1;
+    return RC_END_OF_FILE;
+  }
+  tuple = inputs[last]->tuple;
+  return 0;
+}
+
+void ExternalSort::endMerge()
+{
+  for (unsigned i = 0; i < inputs.size(); i++) {
+    inputs[i]->pf.close();
+    PageFile::remove(inputs[i]->name);
+    delete inputs[i];
+  }
+  inputs.clear();
+  losers.clear();
+  last = -1;
+}
+
+RC ExternalSort::next(int& key, const char*& value)
+{
+  const char* t;
+  RC          rc;
+
+  if (!returning) {
+    returning = true;
+
+    if (runs.empty()) {
+      // all tuples fit in memory
+      Less less = { this };
+      std::stable_sort(tuples.begin(), tuples.end(), less);
+      nextTuple = 0;
+    } else {
+      if ((rc = writeRun()) < 0) return rc;
+      for (unsigned i = 0; i < blocks.size(); i++) delete [] blocks[i];
+      blocks.clear();
+
+      // merge the first runs into one until all runs can be merged at once.
+      // the merged run takes the place of its runs to keep equal tuples in order
+      while (runs.size() > (unsigned)MAX_FAN_IN) {
+        RunWriter* w = new RunWriter;
+        if ((rc = openRun(*w)) == 0 && (rc = startMerge(MAX_FAN_IN)) == 0) {
+          while ((rc = nextMerged(t)) == 0) {
+            if ((rc = writeTuple(*w, t)) < 0) break;
+          }
+          if (rc == RC_END_OF_FILE) rc = closeRun(*w);
+        }
+        endMerge();
+        runs.insert(runs.begin(), w->name);
+        delete w;
+        if (rc < 0) return rc;
+      }
+
+      merging = true;
+      if ((rc = startMerge(runs.size())) < 0) return rc;
+    }
+  }
+
+  if (merging) {
+    if ((rc = nextMerged(t)) < 0) return rc;
+  } else {
+    if (nextTuple >= tuples.size()) return RC_END_OF_FILE;
+    t = tuples[nextTuple++];
+  }
+
+  memcpy(&key, t, sizeof(int));
+  value = t + sizeof(int);
+  return 0;
+}
@@ -0,0 +1,122 @@
+/*
+ * ExternalSort: the tuples of an ORDER BY sorted in runs that spill to disk.
+ */
+
+#ifndef EXTERNALSORT_H
+#define EXTERNALSORT_H
+
+#include <string>
+#include <vector>
+#include "Bruinbase.h"
+#include "PageFile.h"
+
+/**
+ * Sorts (key, value) tuples by the key or the value column.
+ *
+ * The tuples are copied into an arena of large blocks and sorted through
+ * an array of pointers to them. Once the arena and the array reach the
+ * given memory budget, the tuples in memory are sorted and written as a
+ * run to a temporary PageFile. At the end, the runs are merged with a
+ * loser tree, MAX_FAN_IN runs at a time. Tuples with equal sort columns
+ * are returned in the order they were added.
+ */
+class ExternalSort {
+ public:
+  static const int MAX_FAN_IN = 64;          // # runs merged at once
+  static const int ARENA_BLOCK = 64 * 1024;  // the size of an arena block
+
+  /**
+   * @param byValue[IN] true to sort by the value column, false for the key column
+   * @param descending[IN] true to return the largest tuple first
+   * @param spillName[IN] the prefix of the names of the temporary files
+   * @param budget[IN] # bytes the tuples in memory may use
+   */
+  ExternalSort(bool byValue, bool descending, const std::string& spillName, size_t budget);
+  ~ExternalSort();
+
+  /**
+   * add a tuple.
+   * @param key[IN] the key of the tuple
+   * @param value[IN] the value of the tuple
+   * @return error code. 0 if no error
+   */
+  RC add(int key, const char* value);
+
+  /**
+   * get the next tuple in the sort order.
+   * no tuple may be added once a tuple is returned.
+   * @param key[OUT] the key of the tuple
+   * @param value[OUT] the value of the tuple. valid until the next call
+   * @return error code. RC_END_OF_FILE if there is no more tuple
+   */
+  RC next(int& key, const char*& value);
+
+ private:
+  ExternalSort(const ExternalSort&);
+  ExternalSort& operator=(const ExternalSort&);
+
+  // a tuple is stored as its 4-byte key followed by the null-terminated
+  // value, in memory as well as in the pages of a run. a page starts with
+  // the number of tuples in it
+
+  // a run being read by a merge
+  struct RunReader {
+    std::string name;
+    PageFile    pf;
+    PageId      pid;     // the page in page
+    int         left;    // # tuples after tuple in page
+    const char* tuple;   // the current tuple. NULL at the end of the run
+    char        page[PageFile::MAX_PAGE_SIZE];
+  };
+
+  // a run being written
+  struct RunWriter {
+    std::string name;
+    PageFile    pf;
+    PageId      pid;
+    int         count;   // # tuples in page
+    int         used;    // # bytes used in page
+    char        page[PageFile::MAX_PAGE_SIZE];
+  };
+
+  // orders the tuples in memory
+  struct Less {
+    const ExternalSort* sort;
+    bool operator()(const char* a, const char* b) const;
+  };
+
+  int  compare(const char* a, const char* b) const;
+  bool before(int a, int b) const;
+  void adjust(int s);
+
+  RC   openRun(RunWriter& w);
+  RC   writeTuple(RunWriter& w, const char* tuple);
+  RC   closeRun(RunWriter& w);
+  RC   writeRun();
+  RC   advance(RunReader& r);
+  RC   startMerge(int n);
+  RC   nextMerged(const char*& tuple);
+  void endMerge();
+
+  bool   byValue;
+  bool   descending;
+  std::string spillName;
+  size_t budget;
+
+  std::vector<const char*> tuples;  // the tuples in memory
+  std::vector<char*> blocks;        // the arena
+  unsigned           block;         // the block being filled
+  int                blockUsed;     // # bytes used in the block
+
+  std::vector<std::string> runs;    // the runs to merge, in the order they were written
+
+  std::vector<RunReader*> inputs;   // the runs being merged
+  std::vector<int>        losers;   // the loser tree over inputs. losers[0] is the winner
+  int                     last;     // the input of the last tuple returned. -1 if none
+
+  bool     returning;  // are the tuples being returned?
+  bool     merging;    // are they returned from the runs?
+  unsigned nextTuple;  // the next tuple in memory to return
+};
+
+#endif // EXTERNALSORT_H
@@ -0,0 +1,53 @@
+/*
+ * Hash: the hash functions of the hash-based operators.
+ */
+
+#ifndef HASH_H
+#define HASH_H
+
+#include <cstddef>
+
+/**
+ * The keys and values are hashed into 32 bits. The table of an operator
+ * uses the low bits of the hash, and the partition a tuple is spilled to
+ * is chosen by hashPartition() from bits that are mixed again for every
+ * spill level, so that the tuples of a partition spread over all the
+ * partitions of the next level.
+ */
+
+// mix the bits of h (the finalizer of MurmurHash3)
+inline unsigned hashMix(unsigned h)
+{
+  h ^= h >> 16;
+  h *= 0x85ebca6bu;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35u;
+  h ^= h >> 16;
+  return h;
+}
+
+// the hash of a key
+inline unsigned hashKey(int key)
+{
+  return hashMix((unsigned)key);
+}
+
+// the hash of the length bytes of a value
+inline unsigned hashValue(const char* value, size_t length)
+{
+  // FNV-1a, with the bits mixed at the end for the table index
+  unsigned h = 2166136261u;
+  for (size_t i = 0; i < length; i++) {
+    h ^= (unsigned char)value[i];
+    h *= 16777619u;
+  }
+  return hashMix(h);
+}
+
+// the partition out of n of a hash at a spill level
+inline int hashPartition(unsigned hash, int level, int n)
+{
+  return (hashMix(hash ^ (0x9e3779b9u * (level + 1))) >> 16) % n;
+}
+
+#endif // HASH_H
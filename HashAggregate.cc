@@ -0,0 +1,276 @@
+/*
+ * HashAggregate: the groups of a GROUP BY in a hash table that spills to disk.
+ */
+
+#include "HashAggregate.h"
+#include "Hash.h"
+#include <cstring>
+
+using std::string;
+
+// the entry of a group starts with its Aggregate. the entries are
+// 8-byte aligned, so that the Aggregate can be used in place
+static const size_t ENTRY_HEADER = sizeof(Aggregate);
+static const size_t ENTRY_ALIGN = 8;
+
+// the size of the table when the first group is added
+static const size_t FIRST_SLOTS = 1024;
+
+// a spilled tuple is its hash, its key, the length of its value
+// (0 when grouping by key) and the null-terminated value
+static const size_t RECORD_HEADER = sizeof(unsigned) + sizeof(int) + sizeof(unsigned short);
+
+HashAggregate::HashAggregate(bool value, const string& name, size_t bytes)
+  : byValue(value), spillName(name), budget(bytes), level(0),
+    groups(0), blockUsed(ARENA_BLOCK), returning(false), nextSlot(0)
+{
+  for (int i = 0; i < SPILL_PARTITIONS; i++) partitions[i] = NULL;
+}
+
+HashAggregate::~HashAggregate()
+{
+  clear();
+
+  // remove the temporary files that were not aggregated
+  for (int i = 0; i < SPILL_PARTITIONS; i++) {
+    if (partitions[i] == NULL) continue;
+    partitions[i]->pf->close();
+    delete partitions[i]->pf;
+    PageFile::remove(partitions[i]->name);
+    delete partitions[i];
+  }
+  for (unsigned i = 0; i < spilled.size(); i++) PageFile::remove(spilled[i].name);
+}
+
+void HashAggregate::clear()
+{
+  for (unsigned i = 0; i < blocks.size(); i++) delete [] blocks[i];
+  blocks.clear();
+  blockUsed = ARENA_BLOCK;
+  slots.clear();
+  groups = 0;
+}
+
+char* HashAggregate::find(unsigned hash, int key, const char* value, size_t length)
+{
+  if (slots.empty()) return NULL;
+
+  size_t mask = slots.size() - 1;
+  for (size_t i = hash & mask; slots[i].entry != NULL; i = (i + 1) & mask) {
+    if (slots[i].hash != hash) continue;
+
+    const char* k = slots[i].entry + ENTRY_HEADER;
+    if (byValue ? memcmp(k, value, length + 1) == 0 : memcmp(k, &key, sizeof(int)) == 0) {
+      return slots[i].entry;
+    }
+  }
+  return NULL;
+}
+
+bool HashAggregate::grow()
+{
+  size_t size = slots.empty() ? FIRST_SLOTS : slots.size() * 2;
+  size_t used = blocks.size() * ARENA_BLOCK + size * sizeof(Slot);
+  if (used > budget && level < MAX_SPILL_LEVEL) return false;
+
+  // move the groups to their slots in the larger table
+  std::vector<Slot> old(size);
+  old.swap(slots);
+  for (size_t i = 0; i < size; i++) slots[i].entry = NULL;
+  size_t mask = size - 1;
+  for (size_t i = 0; i < old.size(); i++) {
+    if (old[i].entry == NULL) continue;
+    size_t j = old[i].hash & mask;
+    while (slots[j].entry != NULL) j = (j + 1) & mask;
+    slots[j] = old[i];
+  }
+  return true;
+}
+
+char* HashAggregate::insert(unsigned hash, int key, const char* value, size_t length)
+{
+  // the table is kept at most half full
+  if ((groups + 1) * 2 > slots.size() && !grow()) return NULL;
+
+  size_t size = ENTRY_HEADER + (byValue ? length + 1 : sizeof(int));
+  size = (size + ENTRY_ALIGN - 1) / ENTRY_ALIGN * ENTRY_ALIGN;
+  if (blockUsed + size > (size_t)ARENA_BLOCK) {
+    size_t used = (blocks.size() + 1) * ARENA_BLOCK + slots.size() * sizeof(Slot);
+    if (used > budget && level < MAX_SPILL_LEVEL) return NULL;
+    blocks.push_back(new char[ARENA_BLOCK]);
+    blockUsed = 0;
+  }
+  char* entry = blocks.back() + blockUsed;
+  blockUsed += size;
+
+  Aggregate agg;
+  memcpy(entry, &agg, sizeof(agg));
+  if (byValue) memcpy(entry + ENTRY_HEADER, value, length + 1);
+  else memcpy(entry + ENTRY_HEADER, &key, sizeof(int));
+
+  size_t mask = slots.size() - 1;
+  size_t i = hash & mask;
+  while (slots[i].entry != NULL) i = (i + 1) & mask;
+  slots[i].hash = hash;
+  slots[i].entry = entry;
+  groups++;
+
+  return entry;
+}
+
+RC HashAggregate::add(int key, const char* value)
+{
+  if (returning) return RC_INVALID_ATTRIBUTE;
+
+  size_t length = byValue ? strlen(value) : 0;
+  unsigned hash = byValue ? hashValue(value, length) : hashKey(key);
+  return addHashed(hash, key, value, length);
+}
+
+RC HashAggregate::addHashed(unsigned hash, int key, const char* value, size_t length)
+{
+  char* entry = find(hash, key, value, length);
+  if (entry == NULL) entry = insert(hash, key, value, length);
+
+  // the group does not fit in memory. the tuple is aggregated later
+  if (entry == NULL) return spill(hash, key, value, length);
+
+  ((Aggregate*)entry)->add(key);
+  return 0;
+}
+
+RC HashAggregate::spill(unsigned hash, int key, const char* value, size_t length)
+{
+  RC rc;
+  Partition*& p = partitions[hashPartition(hash, level, SPILL_PARTITIONS)];
+
+  if (p == NULL) {
+    p = new Partition;
+    p->pf = new PageFile;
+    p->pid = 0;
+    p->count = 0;
+    p->used = sizeof(int);
+    if ((rc = p->pf->openTemp(spillName + ".grp", p->name)) < 0) {
+      delete p->pf;
+      delete p;
+      p = NULL;
+      return rc;
+    }
+  }
+
+  unsigned short n = byValue ? length + 1 : 0;
+  if (p->used + RECORD_HEADER + n > (size_t)p->pf->getPageSize()) {
+    if ((rc = flushPartition(*p)) < 0) return rc;
+  }
+
+  char* r = p->page + p->used;
+  memcpy(r, &hash, sizeof(unsigned));
+  memcpy(r + sizeof(unsigned), &key, sizeof(int));
+  memcpy(r + sizeof(unsigned) + sizeof(int), &n, sizeof(unsigned short));
+  if (n > 0) memcpy(r + RECORD_HEADER, value, n);
+  p->used += RECORD_HEADER + n;
+  p->count++;
+
+  return 0;
+}
+
+RC HashAggregate::flushPartition(Partition& p)
+{
+  // the page starts with the number of tuples in it
+  memcpy(p.page, &p.count, sizeof(int));
+  RC rc = p.pf->write(p.pid++, p.page);
+  p.count = 0;
+  p.used = sizeof(int);
+  return rc;
+}
+
+RC HashAggregate::endPass()
+{
+  RC rc = 0;
+
+  // the partitions of this pass are aggregated after the groups in memory
+  for (int i = 0; i < SPILL_PARTITIONS; i++) {
+    Partition* p = partitions[i];
+    if (p == NULL) continue;
+
+    if (p->count > 0 && rc == 0) rc = flushPartition(*p);
+    RC closed = p->pf->close();
+    if (rc == 0) rc = closed;
+
+    Spilled s;
+    s.name = p->name;
+    s.level = level + 1;
+    spilled.push_back(s);
+
+    delete p->pf;
+    delete p;
+    partitions[i] = NULL;
+  }
+  return rc;
+}
+
+RC HashAggregate::loadSpilled()
+{
+  Spilled  s = spilled.back();
+  PageFile pf;
+  char     page[PageFile::MAX_PAGE_SIZE];
+  RC       rc;
+
+  spilled.pop_back();
+  clear();
+  level = s.level;
+
+  if ((rc = pf.open(s.name, 'r')) < 0) return rc;
+  pf.advise(PageFile::SEQUENTIAL);
+  for (PageId pid = 0; pid < pf.endPid() && rc == 0; pid++) {
+    if ((rc = pf.read(pid, page)) < 0) break;
+
+    int count;
+    memcpy(&count, page, sizeof(int));
+    const char* r = page + sizeof(int);
+    for (int i = 0; i < count && rc == 0; i++) {
+      unsigned hash;
+      int      key;
+      unsigned short n;
+      memcpy(&hash, r, sizeof(unsigned));
+      memcpy(&key, r + sizeof(unsigned), sizeof(int));
+      memcpy(&n, r + sizeof(unsigned) + sizeof(int), sizeof(unsigned short));
+      rc = addHashed(hash, key, r + RECORD_HEADER, n > 0 ? n - 1 : 0);
+      r += RECORD_HEADER + n;
+    }
+  }
+  pf.close();
+  PageFile::remove(s.name);
+  if (rc < 0) return rc;
+
+  // the groups that still did not fit are partitioned again
+  return endPass();
+}
+
+RC HashAggregate::next(int& key, const char*& value, Aggregate& agg)
+{
+  RC rc;
+
+  if (!returning) {
+    returning = true;
+    nextSlot = 0;
+    if ((rc = endPass()) < 0) return rc;
+  }
+
+  for (;;) {
+    while (nextSlot < slots.size()) {
+      const Slot& s = slots[nextSlot++];
+      if (s.entry == NULL) continue;
+
+      memcpy(&agg, s.entry, sizeof(Aggregate));
+      if (byValue) value = s.entry + ENTRY_HEADER;
+      else memcpy(&key, s.entry + ENTRY_HEADER, sizeof(int));
+      return 0;
+    }
+
+    // all groups in memory are returned. go on with a spilled partition
+    if (spilled.empty()) return RC_END_OF_FILE;
+    if ((rc = loadSpilled()) < 0) return rc;
+    nextSlot = 0;
+  }
+}
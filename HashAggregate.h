@@ -0,0 +1,154 @@
+/*
+ * HashAggregate: the groups of a GROUP BY in a hash table that spills to disk.
+ */
+
+#ifndef HASHAGGREGATE_H
+#define HASHAGGREGATE_H
+
+#include <climits>
+#include <string>
+#include <vector>
+#include "Bruinbase.h"
+#include "PageFile.h"
+
+/**
+ * the aggregates over the key column of a set of tuples
+ */
+struct Aggregate {
+  int       count;  // # tuples
+  long long sum;    // the sum of their keys
+  int       min;    // the smallest key
+  int       max;    // the largest key
+
+  Aggregate() : count(0), sum(0), min(INT_MAX), max(INT_MIN) {}
+
+  // add a tuple with the key
+  void add(int key)
+  {
+    count++;
+    sum += key;
+    if (key < min) min = key;
+    if (key > max) max = key;
+  }
+
+  // add the tuples at the positions sel[0..n-1] of a batch
+  void add(const int* keys, const int* sel, int n)
+  {
+    for (int i = 0; i < n; i++) add(keys[sel[i]]);
+  }
+
+  // add the tuples seen by another aggregate
+  void merge(const Aggregate& a)
+  {
+    count += a.count;
+    sum += a.sum;
+    if (a.min < min) min = a.min;
+    if (a.max > max) max = a.max;
+  }
+};
+
+/**
+ * Groups tuples by the key or the value column and computes the Aggregate
+ * of every group.
+ *
+ * The groups live in an open-addressing hash table with linear probing.
+ * A slot of the table holds the hash of a group and a pointer to its
+ * entry, which is the Aggregate followed by the key or the null-terminated
+ * value of the group. The entries are allocated from an arena of large
+ * blocks, so a group costs no allocation of its own and all groups are
+ * freed at once.
+ *
+ * The table and the arena use at most the given memory budget. Once it
+ * is reached, no group is created in memory any more: the tuples of the
+ * groups that are not in memory are written to one of SPILL_PARTITIONS
+ * temporary PageFiles chosen by their hash, while the groups in memory
+ * keep being updated. After the groups in memory are returned, every
+ * partition is aggregated the same way with other bits of the hash,
+ * and partitioned again if its groups still do not fit.
+ */
+class HashAggregate {
+ public:
+  static const int SPILL_PARTITIONS = 8;
+  static const int MAX_SPILL_LEVEL = 8;     // # times a tuple is spilled at most
+  static const int ARENA_BLOCK = 64 * 1024; // the size of an arena block
+
+  /**
+   * @param byValue[IN] true to group by the value column, false for the key column
+   * @param spillName[IN] the prefix of the names of the temporary files
+   * @param budget[IN] # bytes the hash table and the arena may use
+   */
+  HashAggregate(bool byValue, const std::string& spillName, size_t budget);
+  ~HashAggregate();
+
+  /**
+   * add a tuple to its group.
+   * @param key[IN] the key of the tuple
+   * @param value[IN] the value of the tuple. not used when grouping by key
+   * @return error code. 0 if no error
+   */
+  RC add(int key, const char* value);
+
+  /**
+   * get the next group, in no particular order.
+   * no tuple may be added once a group is returned.
+   * @param key[OUT] the key of the group when grouping by key
+   * @param value[OUT] the value of the group when grouping by value.
+   *                   valid until the next call
+   * @param agg[OUT] the aggregate of the group
+   * @return error code. RC_END_OF_FILE if there is no more group
+   */
+  RC next(int& key, const char*& value, Aggregate& agg);
+
+ private:
+  HashAggregate(const HashAggregate&);
+  HashAggregate& operator=(const HashAggregate&);
+
+  struct Slot {
+    unsigned hash;
+    char*    entry;  // NULL if the slot is empty
+  };
+
+  // a temporary file with the tuples of the groups that did not fit
+  struct Partition {
+    std::string name;
+    PageFile*   pf;       // NULL if no tuple was written
+    PageId      pid;      // the page in page
+    int         count;    // # tuples in page
+    int         used;     // # bytes used in page
+    char        page[PageFile::MAX_PAGE_SIZE];
+  };
+
+  // a partition waiting to be aggregated
+  struct Spilled {
+    std::string name;
+    int         level;  // the spill level of its groups
+  };
+
+  char* find(unsigned hash, int key, const char* value, size_t length);
+  char* insert(unsigned hash, int key, const char* value, size_t length);
+  bool  grow();
+  void  clear();
+  RC    spill(unsigned hash, int key, const char* value, size_t length);
+  RC    flushPartition(Partition& p);
+  RC    endPass();
+  RC    loadSpilled();
+  RC    addHashed(unsigned hash, int key, const char* value, size_t length);
+
+  bool   byValue;
+  std::string spillName;
+  size_t budget;
+  int    level;      // how many times the tuples being added were spilled
+
+  std::vector<Slot>  slots;   // the hash table. the size is a power of 2
+  size_t             groups;  // # groups in the table
+  std::vector<char*> blocks;  // the arena
+  int                blockUsed; // # bytes used in the last block
+
+  Partition* partitions[SPILL_PARTITIONS];  // the partitions of this pass
+  std::vector<Spilled> spilled;             // the partitions to aggregate later
+
+  bool     returning;  // are the groups being returned?
+  unsigned nextSlot;   // the slot of the next group to return
+};
+
+#endif // HASHAGGREGATE_H
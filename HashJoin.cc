@@ -0,0 +1,358 @@
+/*
+ * HashJoin: an equi-join of two tables in a hash table that spills to disk.
+ */
+
+#include "HashJoin.h"
+#include "Hash.h"
+#include <cstring>
+
+using std::string;
+
+// a build tuple in the arena is the pointer to the previous tuple with
+// the same key (or value), its key and its null-terminated value. the
+// entries are aligned for the pointer
+static const size_t ENTRY_HEADER = sizeof(char*) + sizeof(int);
+static const size_t ENTRY_ALIGN = 8;
+
+// the size of the table when the first tuple is added
+static const size_t FIRST_SLOTS = 1024;
+
+// a spilled tuple is its hash, its key, the length of its value
+// including the terminating null and the value
+static const size_t RECORD_HEADER = sizeof(unsigned) + sizeof(int) + sizeof(unsigned short);
+
+static inline char* nextOf(const char* entry)
+{
+  char* next;
+  memcpy(&next, entry, sizeof(char*));
+  return next;
+}
+
+static inline int keyOf(const char* entry)
+{
+  int key;
+  memcpy(&key, entry + sizeof(char*), sizeof(int));
+  return key;
+}
+
+HashJoin::HashJoin(bool value, const string& name, size_t bytes)
+  : byValue(value), spillName(name), budget(bytes), level(0),
+    keys(0), blockUsed(ARENA_BLOCK), spilling(false)
+{
+  for (int i = 0; i < SPILL_PARTITIONS; i++) buildParts[i] = probeParts[i] = NULL;
+}
+
+HashJoin::~HashJoin()
+{
+  clear();
+
+  // remove the temporary files that were not joined
+  for (int i = 0; i < SPILL_PARTITIONS; i++) {
+    closePartition(buildParts[i], true);
+    closePartition(probeParts[i], true);
+  }
+  for (unsigned i = 0; i < spilled.size(); i++) {
+    PageFile::remove(spilled[i].build);
+    PageFile::remove(spilled[i].probe);
+  }
+}
+
+void HashJoin::clear()
+{
+  for (unsigned i = 0; i < blocks.size(); i++) delete [] blocks[i];
+  blocks.clear();
+  blockUsed = ARENA_BLOCK;
+  slots.clear();
+  keys = 0;
+}
+
+HashJoin::Slot* HashJoin::find(unsigned hash, int key, const char* value, size_t length)
+{
+  if (slots.empty()) return NULL;
+
+  size_t mask = slots.size() - 1;
+  for (size_t i = hash & mask; slots[i].entry != NULL; i = (i + 1) & mask) {
+    if (slots[i].hash != hash) continue;
+
+    const char* e = slots[i].entry;
+    if (byValue ? memcmp(e + ENTRY_HEADER, value, length + 1) == 0 : keyOf(e) == key) {
+      return &slots[i];
+    }
+  }
+  return NULL;
+}
+
+bool HashJoin::grow()
+{
+  size_t size = slots.empty() ? FIRST_SLOTS : slots.size() * 2;
+  size_t used = blocks.size() * ARENA_BLOCK + size * sizeof(Slot);
+  if (used > budget && level < MAX_SPILL_LEVEL) return false;
+
+  // move the chains to their slots in the larger table
+  std::vector<Slot> old(size);
+  old.swap(slots);
+  for (size_t i = 0; i < size; i++) slots[i].entry = NULL;
+  size_t mask = size - 1;
+  for (size_t i = 0; i < old.size(); i++) {
+    if (old[i].entry == NULL) continue;
+    size_t j = old[i].hash & mask;
+    while (slots[j].entry != NULL) j = (j + 1) & mask;
+    slots[j] = old[i];
+  }
+  return true;
+}
+
+bool HashJoin::insert(unsigned hash, int key, const char* value, size_t length)
+{
+  // the table is kept at most half full
+  Slot* s = find(hash, key, value, length);
+  if (s == NULL && (keys + 1) * 2 > slots.size() && !grow()) return false;
+
+  size_t size = ENTRY_HEADER + length + 1;
+  size = (size + ENTRY_ALIGN - 1) / ENTRY_ALIGN * ENTRY_ALIGN;
+  if (blockUsed + size > (size_t)ARENA_BLOCK) {
+    size_t used = (blocks.size() + 1) * ARENA_BLOCK + slots.size() * sizeof(Slot);
+    if (used > budget && level < MAX_SPILL_LEVEL) return false;
+    blocks.push_back(new char[ARENA_BLOCK]);
+    blockUsed = 0;
+  }
+  char* entry = blocks.back() + blockUsed;
+  blockUsed += size;
+
+  if (s == NULL) {
+    size_t mask = slots.size() - 1;
+    size_t i = hash & mask;
+    while (slots[i].entry != NULL) i = (i + 1) & mask;
+    s = &slots[i];
+    s->hash = hash;
+    s->entry = NULL;
+    keys++;
+  }
+
+  // the tuple goes to the head of the chain of its key
+  memcpy(entry, &s->entry, sizeof(char*));
+  memcpy(entry + sizeof(char*), &key, sizeof(int));
+  memcpy(entry + ENTRY_HEADER, value, length + 1);
+  s->entry = entry;
+
+  return true;
+}
+
+RC HashJoin::build(int key, const char* value)
+{
+  size_t length = strlen(value);
+  unsigned hash = byValue ? hashValue(value, length) : hashKey(key);
+  return addBuild(hash, key, value, length);
+}
+
+RC HashJoin::probe(int key, const char* value, Output& out)
+{
+  size_t length = strlen(value);
+  unsigned hash = byValue ? hashValue(value, length) : hashKey(key);
+  return addProbe(hash, key, value, length, out);
+}
+
+RC HashJoin::addBuild(unsigned hash, int key, const char* value, size_t length)
+{
+  RC rc;
+
+  if (!spilling) {
+    if (insert(hash, key, value, length)) return 0;
+
+    // the build side does not fit in memory. all its tuples are partitioned
+    spilling = true;
+    if ((rc = spillTable()) < 0) return rc;
+  }
+
+  return spill(buildParts[hashPartition(hash, level, SPILL_PARTITIONS)], hash, key, value, length);
+}
+
+RC HashJoin::addProbe(unsigned hash, int key, const char* value, size_t length, Output& out)
+{
+  RC rc;
+
+  if (spilling) {
+    // no build tuple has the hash of a tuple whose build partition is empty
+    int i = hashPartition(hash, level, SPILL_PARTITIONS);
+    if (buildParts[i] == NULL) return 0;
+    return spill(probeParts[i], hash, key, value, length);
+  }
+
+  Slot* s = find(hash, key, value, length);
+  if (s == NULL) return 0;
+
+  for (const char* e = s->entry; e != NULL; e = nextOf(e)) {
+    if ((rc = out.match(keyOf(e), e + ENTRY_HEADER, key, value)) != 0) return rc;
+  }
+  return 0;
+}
+
+RC HashJoin::spillTable()
+{
+  RC rc;
+
+  for (size_t i = 0; i < slots.size(); i++) {
+    if (slots[i].entry == NULL) continue;
+
+    unsigned hash = slots[i].hash;
+    Partition*& p = buildParts[hashPartition(hash, level, SPILL_PARTITIONS)];
+    for (const char* e = slots[i].entry; e != NULL; e = nextOf(e)) {
+      const char* value = e + ENTRY_HEADER;
+      if ((rc = spill(p, hash, keyOf(e), value, strlen(value))) < 0) return rc;
+    }
+  }
+  clear();
+
+  return 0;
+}
+
+RC HashJoin::spill(Partition*& p, unsigned hash, int key, const char* value, size_t length)
+{
+  RC rc;
+
+  if (p == NULL) {
+    p = new Partition;
+    p->pf = new PageFile;
+    p->pid = 0;
+    p->count = 0;
+    p->used = sizeof(int);
+    if ((rc = p->pf->openTemp(spillName + ".hj", p->name)) < 0) {
+      delete p->pf;
+      delete p;
+      p = NULL;
+      return rc;
+    }
+  }
+
+  unsigned short n = length + 1;
+  if (p->used + RECORD_HEADER + n > (size_t)p->pf->getPageSize()) {
+    if ((rc = flushPartition(*p)) < 0) return rc;
+  }
+
+  char* r = p->page + p->used;
+  memcpy(r, &hash, sizeof(unsigned));
+  memcpy(r + sizeof(unsigned), &key, sizeof(int));
+  memcpy(r + sizeof(unsigned) + sizeof(int), &n, sizeof(unsigned short));
+  memcpy(r + RECORD_HEADER, value, n);
+  p->used += RECORD_HEADER + n;
+  p->count++;
+
+  return 0;
+}
+
+RC HashJoin::flushPartition(Partition& p)
+{
+  // the page starts with the number of tuples in it
+  memcpy(p.page, &p.count, sizeof(int));
+  RC rc = p.pf->write(p.pid++, p.page);
+  p.count = 0;
+  p.used = sizeof(int);
+  return rc;
+}
+
+void HashJoin::closePartition(Partition*& p, bool remove)
+{
+  if (p == NULL) return;
+
+  // a partition that is removed is not written to the disk first
+  if (remove) p->pf->discard(p->name);
+  else p->pf->close();
+  delete p->pf;
+  delete p;
+  p = NULL;
+}
+
+RC HashJoin::endPass()
+{
+  RC rc = 0;
+
+  // the pairs of partitions of this pass are joined later. a build
+  // partition without probe tuples joins with nothing
+  for (int i = 0; i < SPILL_PARTITIONS; i++) {
+    Partition* b = buildParts[i];
+    Partition* p = probeParts[i];
+    if (b == NULL || p == NULL) {
+      closePartition(buildParts[i], true);
+      closePartition(probeParts[i], true);
+      continue;
+    }
+
+    if (b->count > 0 && rc == 0) rc = flushPartition(*b);
+    if (p->count > 0 && rc == 0) rc = flushPartition(*p);
+
+    Spilled s;
+    s.build = b->name;
+    s.probe = p->name;
+    s.level = level + 1;
+    spilled.push_back(s);
+
+    closePartition(buildParts[i], false);
+    closePartition(probeParts[i], false);
+  }
+  spilling = false;
+
+  return rc;
+}
+
+RC HashJoin::readPartition(const string& name, Output* out)
+{
+  PageFile pf;
+  char     page[PageFile::MAX_PAGE_SIZE];
+  RC       rc;
+
+  if ((rc = pf.open(name, 'r')) < 0) return rc;
+  pf.advise(PageFile::SEQUENTIAL);
+  for (PageId pid = 0; pid < pf.endPid() && rc == 0; pid++) {
+    if ((rc = pf.read(pid, page)) < 0) break;
+
+    int count;
+    memcpy(&count, page, sizeof(int));
+    const char* r = page + sizeof(int);
+    for (int i = 0; i < count && rc == 0; i++) {
+      unsigned hash;
+      int      key;
+      unsigned short n;
+      memcpy(&hash, r, sizeof(unsigned));
+      memcpy(&key, r + sizeof(unsigned), sizeof(int));
+      memcpy(&n, r + sizeof(unsigned) + sizeof(int), sizeof(unsigned short));
+      if (out == NULL) rc = addBuild(hash, key, r + RECORD_HEADER, n - 1);
+      else rc = addProbe(hash, key, r + RECORD_HEADER, n - 1, *out);
+      r += RECORD_HEADER + n;
+    }
+  }
+  pf.close();
+
+  return rc;
+}
+
+RC HashJoin::joinSpilled(Output& out)
+{
+  Spilled s = spilled.back();
+  RC      rc;
+
+  spilled.pop_back();
+  clear();
+  level = s.level;
+
+  rc = readPartition(s.build, NULL);
+  if (rc == 0) rc = readPartition(s.probe, &out);
+  PageFile::remove(s.build);
+  PageFile::remove(s.probe);
+  if (rc != 0) return rc;
+
+  // the pairs whose build side still did not fit are joined later
+  return endPass();
+}
+
+RC HashJoin::finish(Output& out)
+{
+  RC rc;
+
+  if ((rc = endPass()) < 0) return rc;
+  while (!spilled.empty()) {
+    if ((rc = joinSpilled(out)) != 0) return rc;
+  }
+  clear();
+
+  return 0;
+}
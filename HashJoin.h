@@ -0,0 +1,144 @@
+/*
+ * HashJoin: an equi-join of two tables in a hash table that spills to disk.
+ */
+
+#ifndef HASHJOIN_H
+#define HASHJOIN_H
+
+#include <string>
+#include <vector>
+#include "Bruinbase.h"
+#include "PageFile.h"
+
+/**
+ * Joins the tuples of a build side and a probe side on equal keys or values.
+ *
+ * All tuples of the build side are added first. They live in an
+ * open-addressing hash table with linear probing, whose slot holds the
+ * hash of a key (or value) and the chain of the tuples with it. The
+ * tuples are allocated from an arena of large blocks. Then every tuple
+ * of the probe side is looked up in the table and passed to an Output
+ * with each build tuple it joins with.
+ *
+ * If the build side does not fit in the memory budget, the join becomes
+ * a grace hash join: the build tuples are written to SPILL_PARTITIONS
+ * temporary PageFiles chosen by their hash, and so are the probe tuples
+ * afterwards. A probe tuple whose build partition is empty is dropped
+ * right away. finish() then joins every pair of partitions the same way,
+ * and partitions a pair again with other bits of the hash if its build
+ * side still does not fit.
+ */
+class HashJoin {
+ public:
+  static const int SPILL_PARTITIONS = 8;
+  static const int MAX_SPILL_LEVEL = 8;     // # times a tuple is spilled at most
+  static const int ARENA_BLOCK = 64 * 1024; // the size of an arena block
+
+  /**
+   * the receiver of the pairs of tuples that join
+   */
+  class Output {
+   public:
+    virtual ~Output() {}
+
+    /**
+     * take a pair of tuples that join.
+     * @param buildKey[IN] the key of the build tuple
+     * @param buildValue[IN] the value of the build tuple
+     * @param probeKey[IN] the key of the probe tuple
+     * @param probeValue[IN] the value of the probe tuple
+     * @return error code. 0 to go on, positive to stop the join
+     */
+    virtual RC match(int buildKey, const char* buildValue, int probeKey, const char* probeValue) = 0;
+  };
+
+  /**
+   * @param byValue[IN] true to join on the value column, false on the key column
+   * @param spillName[IN] the prefix of the names of the temporary files
+   * @param budget[IN] # bytes the hash table and the arena may use
+   */
+  HashJoin(bool byValue, const std::string& spillName, size_t budget);
+  ~HashJoin();
+
+  /**
+   * add a tuple of the build side.
+   * @param key[IN] the key of the tuple
+   * @param value[IN] the value of the tuple
+   * @return error code. 0 if no error
+   */
+  RC build(int key, const char* value);
+
+  /**
+   * join a tuple of the probe side with the build tuples,
+   * or keep it for finish() if the build side was spilled.
+   * @param key[IN] the key of the tuple
+   * @param value[IN] the value of the tuple
+   * @param out[IN] the receiver of the pairs that join
+   * @return error code, or the positive code of out to stop the join
+   */
+  RC probe(int key, const char* value, Output& out);
+
+  /**
+   * join the tuples that were spilled, after all probe tuples are passed.
+   * @param out[IN] the receiver of the pairs that join
+   * @return error code, or the positive code of out to stop the join
+   */
+  RC finish(Output& out);
+
+ private:
+  HashJoin(const HashJoin&);
+  HashJoin& operator=(const HashJoin&);
+
+  struct Slot {
+    unsigned hash;
+    char*    entry;  // the last build tuple added with the key. NULL if the slot is empty
+  };
+
+  // a temporary file with the tuples of a side that hash to it
+  struct Partition {
+    std::string name;
+    PageFile*   pf;
+    PageId      pid;      // the page in page
+    int         count;    // # tuples in page
+    int         used;     // # bytes used in page
+    char        page[PageFile::MAX_PAGE_SIZE];
+  };
+
+  // a pair of partitions waiting to be joined
+  struct Spilled {
+    std::string build;
+    std::string probe;
+    int         level;  // the spill level of their tuples
+  };
+
+  Slot* find(unsigned hash, int key, const char* value, size_t length);
+  bool  insert(unsigned hash, int key, const char* value, size_t length);
+  bool  grow();
+  void  clear();
+  RC    spillTable();
+  RC    spill(Partition*& p, unsigned hash, int key, const char* value, size_t length);
+  RC    flushPartition(Partition& p);
+  void  closePartition(Partition*& p, bool remove);
+  RC    endPass();
+  RC    joinSpilled(Output& out);
+  RC    readPartition(const std::string& name, Output* out);
+  RC    addBuild(unsigned hash, int key, const char* value, size_t length);
+  RC    addProbe(unsigned hash, int key, const char* value, size_t length, Output& out);
+
+  bool   byValue;
+  std::string spillName;
+  size_t budget;
+  int    level;      // how many times the tuples being joined were spilled
+
+  std::vector<Slot>  slots;   // the hash table. the size is a power of 2
+  size_t             keys;    // # distinct keys in the table
+  std::vector<char*> blocks;  // the arena
+  int                blockUsed; // # bytes used in the last block
+
+  bool       spilling;  // are the tuples written to the partitions?
+  Partition* buildParts[SPILL_PARTITIONS];  // the partitions of this pass
+  Partition* probeParts[SPILL_PARTITIONS];
+  std::vector<Spilled> spilled;             // the pairs to join later
+};
+
+#endif // HASHJOIN_H
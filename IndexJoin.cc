@@ -0,0 +1,92 @@
+/*
+ * IndexJoin: an equi-join on the key that looks up the keys of one table
+ * in the index of the other.
+ */
+
+#include "IndexJoin.h"
+
+using std::string;
+
+IndexJoin::IndexJoin(BTreeIndex& idx, const RecordFile& rf, const Predicate& p,
+                     bool v, const string& spillName, size_t budget)
+  : index(idx), inner(rf), pred(p), needValue(v), outer(false, false, spillName, budget)
+{
+}
+
+RC IndexJoin::add(int key, const char* value)
+{
+  return outer.add(key, value);
+}
+
+RC IndexJoin::finish(HashJoin::Output& out)
+{
+  int         key;
+  const char* value;
+  RC          rc;
+
+  rc = outer.next(key, value);
+  while (rc == 0) {
+    // gather the outer tuples with the key
+    int k = key;
+    values.clear();
+    do {
+      values.push_back(value);
+    } while ((rc = outer.next(key, value)) == 0 && key == k);
+    if (rc < 0 && rc != RC_END_OF_FILE) return rc;
+
+    RC probed = probe(k, out);
+    if (probed != 0) return probed;
+  }
+  return (rc == RC_END_OF_FILE) ? 0 : rc;
+}
+
+RC IndexJoin::probe(int k, HashJoin::Output& out)
+{
+  IndexCursor cursor;
+  RecordId    rids[FETCH_BATCH];
+  char        value[RecordFile::MAX_VALUE_LENGTH];
+  const char* valuePtr = "";
+  int         sel[1];
+  int         key;
+  RC          rc;
+
+  // the conditions on the key hold for all the inner tuples with k or none
+  if (pred.selectKeys(&k, 1, sel) == 0) return 0;
+
+  // the cursor is left before the first key not smaller than k
+  rc = index.locate(k, cursor);
+  if (rc == RC_END_OF_TREE) return 0;
+  if (rc < 0 && rc != RC_NO_SUCH_RECORD) return rc;
+
+  bool more = true;
+  while (more) {
+    int n = 0;
+    while (n < FETCH_BATCH) {
+      if ((rc = index.readForward(cursor, key, rids[n])) != 0 || key != k) {
+        more = false;
+        break;
+      }
+      n++;
+    }
+    if (rc < 0 && rc != RC_END_OF_TREE) return rc;
+
+    // the table pages of the batch are read at the same time
+    if (needValue) {
+      for (int i = 0; i < n; i++) inner.prefetch(rids[i]);
+      PageFile::submit();
+    }
+
+    for (int i = 0; i < n; i++) {
+      if (needValue) {
+        if ((rc = inner.read(rids[i], key, value)) < 0) return rc;
+        valuePtr = value;
+        sel[0] = 0;
+        if (pred.selectValues(&valuePtr, sel, 1) == 0) continue;
+      }
+      for (unsigned j = 0; j < values.size(); j++) {
+        if ((rc = out.match(k, valuePtr, k, values[j].c_str())) != 0) return rc;
+      }
+    }
+  }
+  return 0;
+}
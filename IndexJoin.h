@@ -0,0 +1,72 @@
+/*
+ * IndexJoin: an equi-join on the key that looks up the keys of one table
+ * in the index of the other.
+ */
+
+#ifndef INDEXJOIN_H
+#define INDEXJOIN_H
+
+#include <string>
+#include <vector>
+#include "Bruinbase.h"
+#include "BTreeIndex.h"
+#include "ExternalSort.h"
+#include "HashJoin.h"
+#include "Predicate.h"
+#include "RecordFile.h"
+
+/**
+ * Joins the tuples of an outer table with the tuples of an inner table
+ * that have the same key, through the index on the key of the inner table.
+ *
+ * The outer tuples are sorted by key first in an ExternalSort, so the
+ * index is searched in ascending key order: a search goes down from the
+ * lowest node it shares with the last one (see BTreeIndex::locate()),
+ * which is mostly the leaf itself. The outer tuples with the same key are
+ * looked up once. The inner tuples are read from the table in batches
+ * only if their values are needed, and they are passed to a
+ * HashJoin::Output as the build tuples, the outer ones as the probe tuples.
+ */
+class IndexJoin {
+ public:
+  static const int FETCH_BATCH = 32;  // # inner tuples read from the table at once
+
+  /**
+   * @param index[IN] the index on the key of the inner table
+   * @param inner[IN] the inner table
+   * @param pred[IN] the conditions on the inner table
+   * @param needValue[IN] true if the values of the inner tuples are needed
+   * @param spillName[IN] the prefix of the names of the temporary files
+   * @param budget[IN] # bytes the sorted outer tuples may use
+   */
+  IndexJoin(BTreeIndex& index, const RecordFile& inner, const Predicate& pred,
+            bool needValue, const std::string& spillName, size_t budget);
+
+  /**
+   * add a tuple of the outer table.
+   * @param key[IN] the key of the tuple
+   * @param value[IN] the value of the tuple
+   * @return error code. 0 if no error
+   */
+  RC add(int key, const char* value);
+
+  /**
+   * join the outer tuples with the inner tuples, after all outer tuples are added.
+   * @param out[IN] the receiver of the pairs that join
+   * @return error code, or the positive code of out to stop the join
+   */
+  RC finish(HashJoin::Output& out);
+
+ private:
+  RC probe(int key, HashJoin::Output& out);
+
+  BTreeIndex&       index;
+  const RecordFile& inner;
+  const Predicate&  pred;
+  bool              needValue;
+
+  ExternalSort             outer;   // the outer tuples
+  std::vector<std::string> values;  // the values of the outer tuples with the key looked up
+};
+
+#endif // INDEXJOIN_H
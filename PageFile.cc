@@ -9,28 +9,94 @@
 
 #include "Bruinbase.h"
 #include "PageFile.h"
+#include "BufferPool.h"
+#include "AsyncIO.h"
+#include <cstdlib>
 #include <cstring>
+#include <vector>
 #include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
 using std::string;
 
 int PageFile::readCount = 0;
+int PageFile::readCallCount = 0;
 int PageFile::writeCount = 0;
-int PageFile::cacheClock = 1;
-struct PageFile::cacheStruct PageFile::readCache[PageFile::CACHE_COUNT];
+int PageFile::defaultPageSize = PageFile::PAGE_SIZE;
+
+//
+// the file header at the beginning of every file created by PageFile
+//
+static const int FILE_MAGIC   = 0x46504242;  // "BBPF" on little endian
+static const int FILE_VERSION = 1;           // the file format version
+
+struct FileHeader {
+  int magic;     // FILE_MAGIC
+  int version;   // FILE_VERSION
+  int pageSize;  // the size of a page of the file
+};
+
+// the sequential read-ahead starts with MIN_READ_AHEAD pages and grows
+// up to MAX_READ_AHEAD bytes per read
+static const int MIN_READ_AHEAD = 4;
+static const int MAX_READ_AHEAD = 256 * 1024;
+
+// holds the buffer pool latch while a PageFile works with the pool,
+// so that PageFiles can be used by several threads
+class PoolLatch {
+ public:
+  PoolLatch()  { BufferPool::lock(); }
+  ~PoolLatch() { BufferPool::unlock(); }
+};
+
+// wait until a page that is being read into the buffer pool, by AsyncIO
+// or by another thread, has arrived or has been dropped after a failure
+static void waitLoaded(int fileId, PageId pid)
+{
+  while (BufferPool::isLoading(fileId, pid)) {
+    AsyncIO::waitFor(fileId, pid);
+    if (BufferPool::isLoading(fileId, pid)) BufferPool::sleep();
+  }
+}
+
+// is size a page size PageFile supports?
+static bool validPageSize(int size)
+{
+  // a power of two between PAGE_SIZE and MAX_PAGE_SIZE
+  return size >= PageFile::PAGE_SIZE && size <= PageFile::MAX_PAGE_SIZE &&
+         (size & (size - 1)) == 0;
+}
 
 PageFile::PageFile() 
 { 
   fd = -1; 
   epid = 0; 
+  fileId = -1;
+  writable = false;
+  map = NULL;
+  mapSize = 0;
+  pageSize = PAGE_SIZE;
+  base = 0;
+  seqLast = -1;
+  raNext = 0;
+  raWindow = 0;
 }
 
 PageFile::PageFile(const string& filename, char mode)
 {
   fd = -1;
   epid = 0;
+  fileId = -1;
+  writable = false;
+  map = NULL;
+  mapSize = 0;
+  pageSize = PAGE_SIZE;
+  base = 0;
+  seqLast = -1;
+  raNext = 0;
+  raWindow = 0;
   open(filename.c_str(), mode);
 }
 
@@ -39,6 +105,7 @@ RC PageFile::open(const string& filename, char mode)
   RC   rc;
   int  oflag;
   struct stat statbuf;
+  PoolLatch latch;
 
   if (fd > 0) return RC_FILE_OPEN_FAILED;
 
@@ -52,6 +119,10 @@ RC PageFile::open(const string& filename, char mode)
   case 'W':
     oflag = (O_RDWR|O_CREAT);
     break;
+  case 'm':
+  case 'M':
+    oflag = O_RDONLY;
+    break;
   default:
     return RC_INVALID_FILE_MODE;
   }
@@ -63,118 +134,457 @@ RC PageFile::open(const string& filename, char mode)
   // get the size of the file to set the end pid
   rc = ::fstat(fd, &statbuf);
   if (rc < 0) { ::close(fd); fd = -1; return RC_FILE_OPEN_FAILED; }
-  epid = statbuf.st_size / PAGE_SIZE;
+
+  // get the page size from the file header. 
+  // a new file gets a header with the default page size
+  if (statbuf.st_size == 0 && (oflag & O_RDWR)) {
+    rc = writeHeader();
+    if (rc == 0 && ::fstat(fd, &statbuf) < 0) rc = RC_FILE_OPEN_FAILED;
+  } else {
+    rc = readHeader(statbuf);
+  }
+  if (rc < 0) { ::close(fd); fd = -1; return rc; }
+  epid = (statbuf.st_size - base) / pageSize;
+  seqLast = -1;
+  raNext = 0;
+  raWindow = 0;
+
+  // in 'm' mode, map the whole file. the pages are read from the
+  // mapping and the buffer pool is not involved
+  if ((mode == 'm' || mode == 'M') && epid > 0) {
+    mapSize = base + (size_t)epid * pageSize;
+    void* addr = ::mmap(NULL, mapSize, PROT_READ, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+      ::close(fd);
+      fd = -1;
+      epid = 0;
+      mapSize = 0;
+      return RC_FILE_OPEN_FAILED;
+    }
+    map = (char*)addr;
+    return 0;
+  }
+
+  // register the file with the buffer pool, which may still hold
+  // its pages from the last time it was open
+  writable = (oflag & O_RDWR) != 0;
+  fileId = BufferPool::openFile(statbuf, writable ? fd : -1, pageSize, base);
+  if (fileId < 0) {
+    ::close(fd);
+    fd = -1;
+    epid = 0;
+    writable = false;
+    return RC_OUT_OF_MEMORY;
+  }
 
   return 0;
 }
 
+RC PageFile::readHeader(const struct stat& statbuf)
+{
+  FileHeader header;
+
+  // a file without the header has 1KB pages from the beginning of the file
+  pageSize = PAGE_SIZE;
+  base = 0;
+  if (statbuf.st_size < (off_t)sizeof(header)) return 0;
+
+  if (::pread(fd, &header, sizeof(header), 0) != sizeof(header)) return RC_FILE_READ_FAILED;
+  if (header.magic != FILE_MAGIC) return 0;
+
+  if (header.version != FILE_VERSION || !validPageSize(header.pageSize)) {
+    return RC_INVALID_FILE_FORMAT;
+  }
+  pageSize = header.pageSize;
+  base = pageSize;
+
+  return 0;
+}
+
+RC PageFile::writeHeader()
+{
+  char page[MAX_PAGE_SIZE];
+  FileHeader header;
+
+  header.magic = FILE_MAGIC;
+  header.version = FILE_VERSION;
+  header.pageSize = defaultPageSize;
+
+  // the header fills a whole page, so that the pages stay aligned
+  memset(page, 0, defaultPageSize);
+  memcpy(page, &header, sizeof(header));
+  if (::pwrite(fd, page, defaultPageSize, 0) != defaultPageSize) return RC_FILE_WRITE_FAILED;
+  writeCount++;
+
+  pageSize = defaultPageSize;
+  base = pageSize;
+
+  return 0;
+}
+
+RC PageFile::setDefaultPageSize(int size)
+{
+  if (!validPageSize(size)) return RC_INVALID_ATTRIBUTE;
+
+  defaultPageSize = size;
+  return 0;
+}
+
 RC PageFile::close()
 {
+  PoolLatch latch;
+
   if (fd <= 0) return RC_FILE_CLOSE_FAILED;
 
-  // close the file
-  if (::close(fd) < 0) return RC_FILE_CLOSE_FAILED;
+  // the descriptor must stay open until no read is pending on it
+  if (AsyncIO::getPendingCount() > 0) AsyncIO::wait();
 
-  // evict all cached pages for this file
-  for (int i = 0; i < CACHE_COUNT; i++) {
-    if (readCache[i].fd == fd && readCache[i].lastAccessed != 0) {
-       readCache[i].fd = 0;
-       readCache[i].pid = 0;
-       readCache[i].lastAccessed = 0;
-    }
+  // a memory-mapped file has nothing to flush
+  if (map != NULL) {
+    ::munmap(map, mapSize);
+    map = NULL;
+    mapSize = 0;
+    ::close(fd);
+    fd = -1;
+    epid = 0;
+    pageSize = PAGE_SIZE;
+    base = 0;
+    return 0;
   }
 
+  // write the modified pages to the disk
+  RC rc = BufferPool::flushFile(fileId);
+
+  // the cached pages of the file stay in the buffer pool.
+  // remember the state of the file so that the pages can be reused
+  // if the file is not modified until it is opened again
+  struct stat statbuf;
+  memset(&statbuf, 0, sizeof(statbuf));
+  ::fstat(fd, &statbuf);
+  BufferPool::closeFile(fileId, statbuf, fd);
+
+  // close the file
+  if (::close(fd) < 0) return RC_FILE_CLOSE_FAILED;
+
   // set the fd and epid to the initial state
   fd = -1; 
   epid = 0;
+  fileId = -1;
+  writable = false;
+  pageSize = PAGE_SIZE;
+  base = 0;
+  return rc;
+}
+
+RC PageFile::discard(const string& filename)
+{
+  // a memory-mapped file has nothing to write anyway
+  if (map != NULL) {
+    close();
+    return remove(filename);
+  }
+
+  {
+    PoolLatch latch;
+
+    if (fd <= 0) return RC_FILE_CLOSE_FAILED;
+
+    // the descriptor must stay open until no read is pending on it
+    if (AsyncIO::getPendingCount() > 0) AsyncIO::wait();
+
+    // unregister the file without flushing it. its pages go away with it
+    struct stat statbuf;
+    memset(&statbuf, 0, sizeof(statbuf));
+    ::fstat(fd, &statbuf);
+    BufferPool::closeFile(fileId, statbuf, fd);
+    BufferPool::removeFile(statbuf);
+    ::close(fd);
+
+    fd = -1;
+    epid = 0;
+    fileId = -1;
+    writable = false;
+    pageSize = PAGE_SIZE;
+    base = 0;
+  }
+
+  return (::unlink(filename.c_str()) < 0) ? RC_FILE_CLOSE_FAILED : 0;
+}
+
+RC PageFile::openTemp(const string& prefix, string& filename)
+{
+  filename.clear();
+
+  const char* dir = ::getenv("TMPDIR");
+  if (dir == NULL || *dir == '\0') dir = "/tmp";
+
+  // mkstemp() creates a file that did not exist, so the file opened
+  // below is always our own
+  string base = prefix.substr(prefix.rfind('/') + 1);
+  string name = string(dir) + "/" + base + ".XXXXXX";
+  std::vector<char> path(name.begin(), name.end());
+  path.push_back('\0');
+
+  int tmp = ::mkstemp(&path[0]);
+  if (tmp < 0) return RC_FILE_OPEN_FAILED;
+  ::close(tmp);
+
+  RC rc = open(&path[0], 'w');
+  if (rc < 0) {
+    ::unlink(&path[0]);
+    return rc;
+  }
+  filename = &path[0];
   return 0;
 }
 
+RC PageFile::remove(const string& filename)
+{
+  struct stat statbuf;
+
+  // the buffer pool must not keep the pages of a file that is gone.
+  // its inode may be used by the next file that is created
+  if (::stat(filename.c_str(), &statbuf) == 0) {
+    PoolLatch latch;
+    BufferPool::removeFile(statbuf);
+  }
+
+  return (::unlink(filename.c_str()) < 0) ? RC_FILE_CLOSE_FAILED : 0;
+}
+
+RC PageFile::flush()
+{
+  if (fd <= 0) return RC_FILE_WRITE_FAILED;
+  if (map != NULL) return 0;
+
+  PoolLatch latch;
+  return BufferPool::flushFile(fileId);
+}
+
 PageId PageFile::endPid() const 
 {
   return epid;
 }
 
+void PageFile::advise(AccessPattern pattern) const
+{
+  if (fd <= 0) return;
+
+  // for a memory-mapped file, advise the kernel on the mapping.
+  // otherwise advise it on the file itself
+  if (map != NULL) {
+    int advice = MADV_NORMAL;
+    if (pattern == SEQUENTIAL) advice = MADV_SEQUENTIAL;
+    if (pattern == RANDOM) advice = MADV_RANDOM;
+    ::madvise(map, mapSize, advice);
+  } else {
+    int advice = POSIX_FADV_NORMAL;
+    if (pattern == SEQUENTIAL) advice = POSIX_FADV_SEQUENTIAL;
+    if (pattern == RANDOM) advice = POSIX_FADV_RANDOM;
+    ::posix_fadvise(fd, 0, 0, advice);
+  }
+}
+
 RC PageFile::seek(PageId pid) const
 {
-  return (::lseek(fd, pid * PAGE_SIZE, SEEK_SET) < 0) ? RC_FILE_SEEK_FAILED : 0;
+  return (::lseek(fd, base + (off_t)pid * pageSize, SEEK_SET) < 0) ? RC_FILE_SEEK_FAILED : 0;
 }
 
 RC PageFile::write(PageId pid, const void* buffer)
 {
-  RC rc;
   if (pid < 0) return RC_INVALID_PID; 
+  if (!writable) return RC_FILE_WRITE_FAILED;
 
-  // seek to the location of the page
-  if ((rc = seek(pid)) < 0) return rc;
+  PoolLatch latch;
 
-  // write the buffer to the disk page
-  if (::write(fd, buffer, PAGE_SIZE) < 0) return RC_FILE_WRITE_FAILED;
+  // update the page in the buffer pool. 
+  // the page is written to the disk later
+  // a read of the page must not overwrite the new content
+  char* frame;
+  for (;;) {
+    waitLoaded(fileId, pid);
+    if ((frame = BufferPool::peekPage(fileId, pid)) != NULL) break;
 
-  // if the page is in read cache, invalidate it
-  for (int i = 0; i < CACHE_COUNT; i++) {
-    if (readCache[i].fd == fd && readCache[i].pid == pid &&
-        readCache[i].lastAccessed != 0) {
-       readCache[i].fd = 0;
-       readCache[i].pid = 0;
-       readCache[i].lastAccessed = 0;
-       break;
-    }
+    // newPage() fails if the page was cached by another thread meanwhile
+    if ((frame = BufferPool::newPage(fileId, pid, false)) != NULL) break;
+    if (BufferPool::peekPage(fileId, pid) == NULL) return RC_FILE_WRITE_FAILED;
   }
+  memcpy(frame, buffer, pageSize);
+  BufferPool::markDirty(fileId, pid);
 
   // if the written pid >= end pid, update the end pid
   if (pid >= epid) epid = pid + 1;
 
-  // increase page write count
-  writeCount++;
-
   return 0;
 }
 
-RC PageFile::read(PageId pid, void* buffer) const
+RC PageFile::read(PageId pid, void* buffer, bool hot) const
 {
   RC rc;
+  const char* page;
+
+  // copy the page from the buffer pool
+  if ((rc = pin(pid, page, hot)) < 0) return rc;
+  memcpy(buffer, page, pageSize);
+  unpin(pid);
 
+  return 0;
+}
+
+RC PageFile::pin(PageId pid, const char*& page, bool hot) const
+{
   if (pid < 0 || pid >= epid) return RC_INVALID_PID; 
 
+  // a page of a memory-mapped file is simply at its offset in the mapping
+  if (map != NULL) {
+    page = map + base + (size_t)pid * pageSize;
+    return 0;
+  }
+
+  PoolLatch latch;
+
   //
-  // if the page is in cache, read it from there
+  // if the page is in the buffer pool, use it from there
   //
-  for (int i = 0; i < CACHE_COUNT; i++) {
-    if (readCache[i].fd == fd && readCache[i].pid == pid && 
-        readCache[i].lastAccessed != 0) {
-       memcpy(buffer, readCache[i].buffer, PAGE_SIZE);
-       readCache[i].lastAccessed = ++cacheClock;
-       return 0;
-    }
+  char* frame = BufferPool::findPage(fileId, pid, hot);
+
+  // the page may still be on its way from an asynchronous read or from
+  // another thread. if the read failed, the page is gone and we read it here
+  while (frame != NULL && BufferPool::isLoading(fileId, pid)) {
+    waitLoaded(fileId, pid);
+    frame = BufferPool::peekPage(fileId, pid);
   }
 
-  // seek to the page
-  if ((rc = seek(pid)) < 0) return rc;
-  
-  // find the cache slot to evict
-  int toEvict = 0; 
-  for (int i = 0; i < CACHE_COUNT; i++) {
-    if (readCache[i].lastAccessed == 0) {
-      toEvict = i;
-      break;
+  while (frame == NULL) {
+    // set up a buffer pool frame for the page, and read the page into it
+    // without the latch. the other threads that need the page wait for it.
+    // pread() leaves the file offset alone, so that the file can be read
+    // by several threads
+    frame = BufferPool::newPage(fileId, pid, hot);
+    if (frame == NULL) {
+      // another thread may have cached the page meanwhile
+      if (BufferPool::peekPage(fileId, pid) == NULL) return RC_OUT_OF_MEMORY;
+      waitLoaded(fileId, pid);
+      frame = BufferPool::peekPage(fileId, pid);
+      continue;
     }
-    if (readCache[i].lastAccessed < readCache[toEvict].lastAccessed) {
-      toEvict = i;
+    BufferPool::startLoad(fileId, pid);
+    BufferPool::unlock();
+    ssize_t n = ::pread(fd, frame, pageSize, base + (off_t)pid * pageSize);
+    BufferPool::lock();
+
+    // endLoad() increases the page read count
+    BufferPool::endLoad(fileId, pid, n >= 0, false);
+    if (n < 0) return RC_FILE_READ_FAILED;
+    readCallCount++;
+  }
+
+  BufferPool::pinPage(fileId, pid);
+  page = frame;
+
+  // a step to the next page looks like a scan. read ahead of it
+  if (pid != seqLast) {
+    if (pid == seqLast + 1) {
+      readAhead(pid);
+    } else {
+      raWindow = 0;
+      raNext = 0;
     }
+    seqLast = pid;
   }
-  readCache[toEvict].fd = fd;
-  readCache[toEvict].pid = pid;
-  readCache[toEvict].lastAccessed = ++cacheClock;
- 
-  // read the page to cache first and copy it to the buffer
-  if (::read(fd, readCache[toEvict].buffer, PAGE_SIZE) < 0) {
-    return RC_FILE_READ_FAILED;
+
+  return 0;
+}
+
+void PageFile::readAhead(PageId pid) const
+{
+  // wait until the scan gets through half of the pages read last time
+  if (raWindow > 0 && pid + raWindow / 2 < raNext) return;
+
+  // the window starts small and doubles as long as the scan goes on
+  int maxWindow = MAX_READ_AHEAD / pageSize;
+  if (maxWindow > AsyncIO::MAX_READ_RUN) maxWindow = AsyncIO::MAX_READ_RUN;
+  if ((size_t)maxWindow > BufferPool::getPoolSize() / pageSize / 4) maxWindow = BufferPool::getPoolSize() / pageSize / 4;
+  if (maxWindow < 1) return;
+
+  raWindow = (raWindow == 0) ? MIN_READ_AHEAD : raWindow * 2;
+  if (raWindow > maxWindow) raWindow = maxWindow;
+
+  PageId start = (raNext > pid) ? raNext : pid + 1;
+  PageId end = start + raWindow;
+  if (end > epid) end = epid;
+  raNext = end;
+
+  // read the pages that are not cached yet. every run of consecutive
+  // missing pages is read with a single request
+  char*  frames[AsyncIO::MAX_READ_RUN];
+  int    n = 0;
+  PageId first = start;
+  for (PageId p = start; p <= end; p++) {
+    if (p < end && BufferPool::peekPage(fileId, p) == NULL) {
+      char* frame = BufferPool::newPage(fileId, p, false);
+      if (frame != NULL) {
+        BufferPool::startLoad(fileId, p);
+        if (n == 0) first = p;
+        frames[n++] = frame;
+        continue;
+      }
+    }
+    if (n > 0 && queueRead(first, frames, n) < 0) break;
+    n = 0;
   }
-  memcpy(buffer, readCache[toEvict].buffer, PAGE_SIZE);
+  AsyncIO::submit();
+}
 
-  // increase the page read count
-  readCount++;
+RC PageFile::queueRead(PageId pid, char* const* frames, int count) const
+{
+  RC rc = AsyncIO::queueRead(fd, base + (off_t)pid * pageSize, frames, count, pageSize, fileId, pid);
+  if (rc < 0) {
+    for (int i = 0; i < count; i++) BufferPool::endLoad(fileId, pid + i, false);
+    return rc;
+  }
 
+  readCallCount++;
   return 0;
 }
+
+RC PageFile::readAsync(PageId pid, bool hot) const
+{
+  if (pid < 0 || pid >= epid) return RC_INVALID_PID;
+
+  // a memory-mapped page is read by the kernel on access anyway
+  if (map != NULL) return 0;
+
+  PoolLatch latch;
+
+  // nothing to do if the page is cached or on its way
+  if (BufferPool::peekPage(fileId, pid) != NULL) return 0;
+
+  // set up a frame for the page and queue its read. newPage() fails
+  // if the page was cached by another thread meanwhile
+  char* frame = BufferPool::newPage(fileId, pid, hot);
+  if (frame == NULL) return (BufferPool::peekPage(fileId, pid) != NULL) ? 0 : RC_OUT_OF_MEMORY;
+  BufferPool::startLoad(fileId, pid);
+
+  return queueRead(pid, &frame, 1);
+}
+
+RC PageFile::submit()
+{
+  PoolLatch latch;
+  return AsyncIO::submit();
+}
+
+RC PageFile::wait()
+{
+  PoolLatch latch;
+  return AsyncIO::wait();
+}
+
+void PageFile::unpin(PageId pid) const
+{
+  if (map != NULL) return;
+
+  PoolLatch latch;
+  BufferPool::unpinPage(fileId, pid);
+}
@@ -11,6 +11,7 @@
 #define PAGEFILE_H
 
 #include <string>
+#include <sys/types.h>
 #include "Bruinbase.h"
 
 typedef int PageId;
@@ -21,44 +22,167 @@ typedef int PageId;
 class PageFile {
  public:
 
-  static const int PAGE_SIZE = 1024;    // the size of a page is 1KB
+  static const int PAGE_SIZE = 1024;          // the default page size is 1KB
+  static const int MAX_PAGE_SIZE = 16 * 1024; // the largest page size
+
+  // A file created by PageFile starts with a header that records the page
+  // size of the file. The header takes up as much space as a page and is
+  // not visible through the PageFile interface, so the first page of a
+  // file is still page 0. A file without a header has 1KB pages.
+
+  /**
+   * the expected access pattern of a file, passed to advise()
+   */
+  enum AccessPattern { NORMAL, SEQUENTIAL, RANDOM };
 
   PageFile();
   PageFile(const std::string& filename, char mode);
 
   /**
    * open a file in read or write mode.
-   * when opened in 'w' mode, if the file does not exist, it is created.
+   * when opened in 'w' mode, if the file does not exist, it is created
+   * with the page size set by setDefaultPageSize().
+   * when opened in 'm' mode, the file is memory-mapped read-only and
+   * pages are accessed in the mapping, bypassing the buffer pool.
+   * 'm' mode must not be used for a file that is being written.
    * @param filename[IN] the name of the file to open
-   * @param mode[IN] 'r' for read, 'w' for write
+   * @param mode[IN] 'r' for read, 'w' for write, 'm' for memory-mapped read
    * @return error code. 0 if no error
    */
   RC open(const std::string& filename, char mode);
 
   /**
-   * close the file.
+   * close the file after writing its modified pages to the disk.
    * @return error code. 0 if no error
    */
   RC close();
+
+  /**
+   * create a temporary file with a unique name and open it in 'w' mode.
+   * the file is created in $TMPDIR (or /tmp) and stays there until it
+   * is deleted with remove().
+   * @param prefix[IN] the beginning of the name of the file
+   * @param filename[OUT] the name of the file created. empty on failure
+   * @return error code. 0 if no error
+   */
+  RC openTemp(const std::string& prefix, std::string& filename);
+
+  /**
+   * close the file and delete it, e.g., a temporary file that is no
+   * longer needed. its modified pages are dropped from the buffer pool
+   * instead of being written to the disk.
+   * @param filename[IN] the name of the file
+   * @return error code. 0 if no error
+   */
+  RC discard(const std::string& filename);
+
+  /**
+   * delete a file that is not open. its pages are dropped from the
+   * buffer pool without being written back.
+   * @param filename[IN] the name of the file to delete
+   * @return error code. 0 if no error
+   */
+  static RC remove(const std::string& filename);
   
   /**
    * read a disk page into memory buffer.
+   * the page is served from the buffer pool if it is cached there.
    * @param pid[IN] the page to read
-   * @param buffer[OUT] pointer to memory buffer
+   * @param buffer[OUT] pointer to memory buffer of at least getPageSize() bytes
+   * @param hot[IN] true if the buffer pool should keep the page resident
+   *                longer than other pages (e.g., b+tree nonleaf nodes)
    * @return error code. 0 if no error
    */
-  RC read(PageId pid, void *buffer) const;
+  RC read(PageId pid, void *buffer, bool hot = false) const;
   
+  /**
+   * pin a page in the buffer pool and get a pointer to it, so that the
+   * page can be accessed in place without copying it.
+   * the page must not be modified through the pointer and has to be
+   * released with unpin() once it is no longer used.
+   * @param pid[IN] the page to pin
+   * @param page[OUT] the pointer to the page in the buffer pool
+   * @param hot[IN] true if the buffer pool should keep the page resident
+   *                longer than other pages (e.g., b+tree nonleaf nodes)
+   * @return error code. 0 if no error
+   */
+  RC pin(PageId pid, const char*& page, bool hot = false) const;
+
+  /**
+   * start reading a page into the buffer pool without waiting for it.
+   * the read goes to the disk with the next submit(), together with the
+   * other queued reads. pin() and read() of the page wait until it has
+   * arrived. nothing is done if the page is already cached.
+   * @param pid[IN] the page to read
+   * @param hot[IN] true if the buffer pool should keep the page resident
+   *                longer than other pages
+   * @return error code. 0 if no error
+   */
+  RC readAsync(PageId pid, bool hot = false) const;
+
+  /**
+   * hand all queued asynchronous reads to the operating system,
+   * without waiting for them to complete.
+   * @return error code. 0 if no error
+   */
+  static RC submit();
+
+  /**
+   * wait until all asynchronous reads and writes are complete.
+   * @return error code. 0 if no error
+   */
+  static RC wait();
+
+  /**
+   * release a page pinned by pin().
+   * @param pid[IN] the pinned page
+   */
+  void unpin(PageId pid) const;
+
   /**
    * write the memory buffer to the disk page.
    * if (pid >= endPid()), the file is expanded such that
    * endPid() becomes (pid + 1).
+   * the page is written to the buffer pool and goes to the disk when
+   * it is replaced in the pool, or when flush() or close() is called.
    * @param pid[IN] page to write to
    * @param buffer[IN] the content to write
    * @return error code. 0 if no error
    */
   RC write(PageId pid, const void *buffer);
+
+  /**
+   * write all modified pages of the file in the buffer pool to the disk.
+   * @return error code. 0 if no error
+   */
+  RC flush();
     
+  /**
+   * tell the operating system how the file is going to be accessed,
+   * so that it can read ahead for sequential scans and avoid useless
+   * read-ahead for index lookups.
+   * @param pattern[IN] the expected access pattern
+   */
+  void advise(AccessPattern pattern) const;
+
+  /**
+   * @return the size of the pages of the file in bytes
+   */
+  int getPageSize() const { return pageSize; }
+
+  /**
+   * set the page size of the files created from now on.
+   * @param size[IN] the page size in bytes. a power of two between
+   *                 PAGE_SIZE and MAX_PAGE_SIZE
+   * @return error code. 0 if no error
+   */
+  static RC setDefaultPageSize(int size);
+
+  /**
+   * @return the page size of newly created files
+   */
+  static int getDefaultPageSize() { return defaultPageSize; }
+
   /**
    * note the +1 part. The last page id in the file is actually endPid()-1.
    * that is, the last page can be read by "read(endPid()-1, buffer)".
@@ -71,6 +195,11 @@ class PageFile {
    */
   static int getPageReadCount()  { return readCount; }
   
+  /**
+   * @return the total # of read system calls (or requests) issued for pages
+   */
+  static int getReadCallCount()  { return readCallCount; }
+
   /**
    * @return the total # of disk writes
    */
@@ -88,25 +217,34 @@ class PageFile {
  private:
   int     fd;     // file descriptor of the associated unix file
   PageId  epid;   // (last page id + 1) of the file
+  int     fileId; // the id of the file in the BufferPool
+  bool    writable; // true if the file is opened in 'w' mode
+  char*   map;      // the mapping of the file in 'm' mode. NULL otherwise
+  size_t  mapSize;  // the length of the mapping
+  int     pageSize; // the size of a page of the file
+  off_t   base;     // the offset of page 0 in the file (after the header)
+
+  RC readHeader(const struct stat& statbuf);
+  RC writeHeader();
 
-  //
-  // the following set of members implement LRU caching 
-  //
-  static const int CACHE_COUNT = 10;
+  // sequential read-ahead: when pin() moves on to the next page, the
+  // following pages are read asynchronously into the buffer pool.
+  // the window doubles while the scan goes on and drops back after
+  // a jump to another page
+  mutable PageId seqLast;  // the page pinned last
+  mutable PageId raNext;   // the page after the pages read ahead
+  mutable int    raWindow; // # pages read ahead last time (0 if none)
 
-  static int cacheClock; // clock tick counter for LRU policy
+  void readAhead(PageId pid) const;
+  RC   queueRead(PageId pid, char* const* frames, int count) const;
 
-  // the actual cache data structure
-  static struct cacheStruct {
-    int    fd;              // file id of the cached page
-    PageId pid;             // page id of the cached page
-    int    lastAccessed;    // the last time the cached page was accessed
-                            //   (lastAccessed == 0) means that the buffer is empty
-    char buffer[PAGE_SIZE]; // the buffer used for caching
-  } readCache[CACHE_COUNT];
+  static int defaultPageSize; // the page size of newly created files
 
   static int readCount;  // total # of page reads 
+  static int readCallCount; // total # of read calls
   static int writeCount; // total # of page writes 
+
+  friend class BufferPool;  // counts the pages it writes back
 };
   
 #endif // PAGEFILE_H
@@ -0,0 +1,118 @@
+/*
+ * Predicate: the conditions of a WHERE clause compiled for batch evaluation.
+ */
+
+#include "Predicate.h"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+using std::vector;
+
+// create the filter for a condition on the value column
+static Filter* valueFilter(const SelCond& cond)
+{
+  switch (cond.comp) {
+  case SelCond::EQ: return new ValueFilter<ValueCompare<SelCond::EQ> >(cond.value);
+  case SelCond::NE: return new ValueFilter<ValueCompare<SelCond::NE> >(cond.value);
+  case SelCond::LT: return new ValueFilter<ValueCompare<SelCond::LT> >(cond.value);
+  case SelCond::GT: return new ValueFilter<ValueCompare<SelCond::GT> >(cond.value);
+  case SelCond::LE: return new ValueFilter<ValueCompare<SelCond::LE> >(cond.value);
+  case SelCond::GE: return new ValueFilter<ValueCompare<SelCond::GE> >(cond.value);
+  }
+  return NULL;
+}
+
+Predicate::Predicate(const vector<SelCond>& cond)
+  : empty(false), low(INT_MIN), high(INT_MAX)
+{
+  vector<int> excluded;  // the keys excluded by "key <> x"
+
+  // fold the key conditions into the range [low, high]
+  for (unsigned i = 0; i < cond.size(); i++) {
+    if (cond[i].attr != 1) continue;
+
+    int v = atoi(cond[i].value);
+    switch (cond[i].comp) {
+    case SelCond::EQ:
+      if (v > low) low = v;
+      if (v < high) high = v;
+      break;
+    case SelCond::GT:
+      if (v == INT_MAX) empty = true;
+      else if (v + 1 > low) low = v + 1;
+      break;
+    case SelCond::GE:
+      if (v > low) low = v;
+      break;
+    case SelCond::LT:
+      if (v == INT_MIN) empty = true;
+      else if (v - 1 < high) high = v - 1;
+      break;
+    case SelCond::LE:
+      if (v < high) high = v;
+      break;
+    case SelCond::NE:
+      excluded.push_back(v);
+      break;
+    }
+  }
+
+  // an excluded key at an end of the range makes the range smaller
+  std::sort(excluded.begin(), excluded.end());
+  excluded.erase(std::unique(excluded.begin(), excluded.end()), excluded.end());
+  while (!empty && low <= high && std::binary_search(excluded.begin(), excluded.end(), low)) {
+    if (low == high) empty = true;
+    else low++;
+  }
+  while (!empty && low < high && std::binary_search(excluded.begin(), excluded.end(), high)) {
+    high--;
+  }
+  if (low > high) empty = true;
+  if (empty) return;
+
+  // the key filters: the range, then the exclusions inside the range
+  if (low != INT_MIN || high != INT_MAX) {
+    keyFilters.push_back(new KeyFilter<KeyRange<int> >(KeyRange<int>(low, high)));
+  }
+  for (unsigned i = 0; i < excluded.size(); i++) {
+    if (excluded[i] > low && excluded[i] < high) {
+      keyFilters.push_back(new KeyFilter<KeyNotEqual>(KeyNotEqual(excluded[i])));
+    }
+  }
+
+  for (unsigned i = 0; i < cond.size(); i++) {
+    if (cond[i].attr == 2) valueFilters.push_back(valueFilter(cond[i]));
+  }
+}
+
+Predicate::~Predicate()
+{
+  for (unsigned i = 0; i < keyFilters.size(); i++) delete keyFilters[i];
+  for (unsigned i = 0; i < valueFilters.size(); i++) delete valueFilters[i];
+}
+
+bool Predicate::getKeyRange(int& lowKey, int& highKey) const
+{
+  lowKey = low;
+  highKey = high;
+  return empty || low != INT_MIN || high != INT_MAX;
+}
+
+int Predicate::selectKeys(const int* keys, int n, int* sel) const
+{
+  for (int i = 0; i < n; i++) sel[i] = i;
+
+  for (unsigned i = 0; i < keyFilters.size() && n > 0; i++) {
+    n = keyFilters[i]->apply(keys, NULL, sel, n);
+  }
+  return n;
+}
+
+int Predicate::selectValues(const char* const* values, int* sel, int n) const
+{
+  for (unsigned i = 0; i < valueFilters.size() && n > 0; i++) {
+    n = valueFilters[i]->apply(NULL, values, sel, n);
+  }
+  return n;
+}
@@ -0,0 +1,183 @@
+/*
+ * Predicate: the conditions of a WHERE clause compiled for batch evaluation.
+ */
+
+#ifndef PREDICATE_H
+#define PREDICATE_H
+
+#include <cstring>
+#include <vector>
+#include "Bruinbase.h"
+#include "SqlEngine.h"
+
+//
+// the comparisons a predicate is built from. each one is a functor that
+// the filters below instantiate, so that the comparison is inlined into
+// the loop over a batch of tuples
+//
+
+// lo <= key <= hi
+template<class T>
+struct KeyRange {
+  T low;
+  T high;
+
+  KeyRange(T l, T h) : low(l), high(h) {}
+  bool operator()(T key) const { return (key >= low) & (key <= high); }
+};
+
+// key <> value
+struct KeyNotEqual {
+  int value;
+
+  KeyNotEqual(int v) : value(v) {}
+  bool operator()(int key) const { return key != value; }
+};
+
+// (value column) C value, e.g., ValueCompare<SelCond::LT> is "value < 'x'"
+template<SelCond::Comparator C>
+struct ValueCompare {
+  const char* value;
+
+  ValueCompare(const char* v) : value(v) {}
+  bool operator()(const char* v) const
+  {
+    int diff = strcmp(v, value);
+    switch (C) {  // C is a constant, so only one case is compiled in
+    case SelCond::EQ: return diff == 0;
+    case SelCond::NE: return diff != 0;
+    case SelCond::LT: return diff < 0;
+    case SelCond::GT: return diff > 0;
+    case SelCond::LE: return diff <= 0;
+    case SelCond::GE: return diff >= 0;
+    }
+    return false;
+  }
+};
+
+/**
+ * A filter applies one comparison to the tuples of a batch.
+ * the positions of the tuples that pass are kept in a selection vector.
+ */
+class Filter {
+ public:
+  virtual ~Filter() {}
+
+  /**
+   * keep the positions in sel[0..n-1] of the tuples that pass the filter.
+   * @param keys[IN] the keys of the batch
+   * @param values[IN] the values of the batch
+   * @param sel[IN/OUT] the positions of the tuples to check
+   * @param n[IN] # positions in sel
+   * @return # positions left in sel
+   */
+  virtual int apply(const int* keys, const char* const* values, int* sel, int n) const = 0;
+};
+
+// a filter that compares the keys with P
+template<class P>
+class KeyFilter : public Filter {
+ public:
+  KeyFilter(const P& pred) : p(pred) {}
+
+  int apply(const int* keys, const char* const* values, int* sel, int n) const
+  {
+    // the loop has no branch on the comparison
+    int m = 0;
+    for (int i = 0; i < n; i++) {
+      sel[m] = sel[i];
+      m += p(keys[sel[i]]);
+    }
+    return m;
+  }
+
+ private:
+  P p;
+};
+
+// a filter that compares the values with P
+template<class P>
+class ValueFilter : public Filter {
+ public:
+  ValueFilter(const P& pred) : p(pred) {}
+
+  int apply(const int* keys, const char* const* values, int* sel, int n) const
+  {
+    int m = 0;
+    for (int i = 0; i < n; i++) {
+      sel[m] = sel[i];
+      m += p(values[sel[i]]);
+    }
+    return m;
+  }
+
+ private:
+  P p;
+};
+
+/**
+ * The conjunction of the conditions of a WHERE clause.
+ * The key conditions are folded into a single key range and a few
+ * "key <> x" exclusions inside it, so contradicting conditions such as
+ * "key > 10 AND key < 5" are found before any page is read.
+ * The value conditions are applied to the tuples that pass the key
+ * conditions only.
+ */
+class Predicate {
+ public:
+  /**
+   * compile the conditions of a WHERE clause.
+   * the values of the conditions must stay valid while the predicate is used.
+   * @param cond[IN] the conditions, all ANDed together
+   */
+  Predicate(const std::vector<SelCond>& cond);
+  ~Predicate();
+
+  /**
+   * @return true if no tuple can satisfy the conditions
+   */
+  bool isEmpty() const { return empty; }
+
+  /**
+   * @return true if there is a condition on the value column
+   */
+  bool needsValue() const { return !valueFilters.empty(); }
+
+  /**
+   * get the key range [low, high] allowed by the key conditions.
+   * @param low[OUT] the smallest key allowed
+   * @param high[OUT] the largest key allowed
+   * @return false if the key conditions do not narrow down the key range
+   */
+  bool getKeyRange(int& low, int& high) const;
+
+  /**
+   * store in sel the positions of the keys[0..n-1] that satisfy all key conditions.
+   * @param keys[IN] the keys of a batch
+   * @param n[IN] # keys in the batch
+   * @param sel[OUT] the positions of the keys that satisfy the conditions
+   * @return # positions stored in sel
+   */
+  int selectKeys(const int* keys, int n, int* sel) const;
+
+  /**
+   * keep the positions in sel[0..n-1] whose value satisfies all value conditions.
+   * @param values[IN] the values of a batch
+   * @param sel[IN/OUT] the positions of the tuples to check
+   * @param n[IN] # positions in sel
+   * @return # positions left in sel
+   */
+  int selectValues(const char* const* values, int* sel, int n) const;
+
+ private:
+  Predicate(const Predicate&);
+  Predicate& operator=(const Predicate&);
+
+  bool empty;      // can no tuple satisfy the conditions?
+  int  low;        // the key range allowed by the key conditions
+  int  high;
+  std::vector<Filter*> keyFilters;    // the filters on the key column
+  std::vector<Filter*> valueFilters;  // the filters on the value column
+};
+
+#endif // PREDICATE_H
@@ -20,48 +20,133 @@ using std::string;
 // compute the pointer to the n'th slot in a page
 static char* slotPtr(char* page, int n);
 
-// read the record in the n'th slot in the page
-static void readSlot(const char* page, int n, int& key, std::string& value);
+// read the key in the n'th slot in the page and locate its value
+static const char* readSlot(const char* page, int n, int& key);
+
+// copy a value of at most MAX_VALUE_LENGTH - 1 characters to a buffer
+static void copyValue(char* buffer, const char* value);
 
 // write the record to the n'th slot in the page
 static void writeSlot(char* page, int n, int key, const std::string& value);
 
+// get # record slots in a page of pageSize bytes
+static int slotsPerPage(int pageSize);
+
 // get # records stored in the page
 static int getRecordCount(const char* page);
 
 // update # records stored in the page
 static void setRecordCount(char* page, int count);
 
+//
+// helper functions for the pages of the SLOTTED format.
+// a page starts with # records and the offset of the end of the free space,
+// followed by the slot directory. the values are stored null-terminated
+// from the end of the page towards the directory:
+//
+//   [count][free end][slot 0][slot 1]...  free space  ...[value 1][value 0]
+//
+
+// a slot of the directory: the key and the location of the value
+struct Slot {
+  int            key;
+  unsigned short offset;  // the offset of the value in the page
+  unsigned short length;  // the length of the value without the null
+};
+
+// get # records in a SLOTTED page of pageSize bytes at most
+static int slottedPerPage(int pageSize);
+
+// get # free bytes in a SLOTTED page
+static int slottedFreeSpace(const char* page);
+
+// initialize an empty SLOTTED page
+static void slottedInit(char* page, int pageSize);
+
+// read the n'th slot of the directory of a SLOTTED page
+static void slottedGetSlot(const char* page, int n, Slot& slot);
+
+// append a record to a SLOTTED page that has enough free space
+static void slottedAppend(char* page, int key, const char* value, int length);
 
 //
-// helper functions for RecordId manipulation
+// helper functions for the pages of the COLUMNAR format.
+// a key page holds the keys of consecutive rows and the id of the value
+// page with the value of its first row. a value page holds the values of
+// consecutive rows, null-terminated from the end of the page towards
+// their offsets:
+//
+//   key page:   [count][value pid][key 0][key 1]...
+//   value page: [first row][count][free end][offset 0][offset 1]...  free space  ...[value 1][value 0]
 //
 
-// postfix record id iterator
-RecordId operator++ (RecordId& rid, int)
-{
-  RecordId prid(rid);
+// get # keys in a key page of pageSize bytes
+static int keysPerPage(int pageSize);
 
-  // if the end of a page is reached, move to the next page
-  if (++rid.sid >= RecordFile::RECORDS_PER_PAGE) {
-    rid.pid++;
-    rid.sid = 0;
-  }
+// get the keys stored in a key page
+static const int* keyPageKeys(const char* page);
 
-  return prid;
-}
+// get the value page of the first row of a key page
+static PageId keyPageValuePid(const char* page);
 
-// prefix record id iterator
-RecordId& operator++ (RecordId& rid)
-{
-  // if the end of a page is reached, move to the next page
-  if (++rid.sid >= RecordFile::RECORDS_PER_PAGE) {
-    rid.pid++;
-    rid.sid = 0;
-  } 
+// initialize an empty key page whose first value is in value page vpid
+static void keyPageInit(char* page, PageId vpid);
+
+// get the first row and # values in a value page
+static void valuePageRange(const char* page, int& firstRow, int& count);
+
+// get # free bytes in a value page
+static int valuePageFreeSpace(const char* page);
+
+// get the n'th value in a value page
+static const char* valuePageValue(const char* page, int n);
+
+// initialize an empty value page starting at firstRow
+static void valuePageInit(char* page, int pageSize, int firstRow);
+
+// append a value to a value page that has enough free space
+static void valuePageAppend(char* page, const char* value, int length);
+
+// read the value of a row, starting the search at the value page vpid
+static RC readColumnValue(const PageFile& vf, PageId vpid, int row, char* value);
+
+//
+// helper functions for the zone map of a file. the zone map keeps the
+// smallest and the largest key of every page with records, in the order
+// of the pages. its first page holds # entries and the other pages the
+// entries:
+//
+//   zone page:  [min 0][max 0][min 1][max 1]...
+//
+
+// get # entries in a zone map page of pageSize bytes
+static int zonesPerPage(int pageSize);
+
+// get the n'th entry of a zone map page
+static void getZone(const char* page, int n, int& minKey, int& maxKey);
+
+// set the n'th entry of a zone map page
+static void setZone(char* page, int n, int minKey, int maxKey);
+
+// get the name of a file kept next to a table file, e.g. table.val
+static std::string sideFileName(const std::string& filename, const char* ext);
+
+//
+// the header page at the beginning of a file that is not in the FIXED format.
+// a FIXED file has records from page 0 on, whose first four bytes hold
+// # records in the page and can never be TABLE_MAGIC
+//
+static const int TABLE_MAGIC = 0x54524242;  // "BBRT" on little endian
+
+struct TableHeader {
+  int magic;   // TABLE_MAGIC
+  int format;  // RecordFile::Format
+};
 
-  return rid;
-}
+
+//
+// helper functions for RecordId manipulation
+//
 
 // RecordId comparators
 bool operator < (const RecordId& r1, const RecordId& r2)
@@ -107,20 +192,61 @@ RecordFile::RecordFile()
 {
   erid.pid = 0;
   erid.sid = 0;
+  format = FIXED;
+  firstPid = 0;
+  recordsPerPage = slotsPerPage(PageFile::PAGE_SIZE);
+  zoned = false;
 }
 
 RecordFile::RecordFile(const string& filename, char mode)
 {
+  erid.pid = 0;
+  erid.sid = 0;
+  format = FIXED;
+  firstPid = 0;
+  recordsPerPage = slotsPerPage(PageFile::PAGE_SIZE);
+  zoned = false;
   open(filename, mode);
 }
 
-RC RecordFile::open(const string& filename, char mode)
+RC RecordFile::open(const string& filename, char mode, Format fmt)
 {
   RC   rc;
-  char page[PageFile::PAGE_SIZE];
+  char page[PageFile::MAX_PAGE_SIZE];
 
   // open the page file
   if ((rc = pf.open(filename, mode)) < 0) return rc;
+
+  // a new file gets the requested format. an existing file tells its
+  // format in the header page, or has no header page if it is FIXED
+  format = fmt;
+  if (pf.endPid() == 0 && format != FIXED && (mode == 'w' || mode == 'W')) {
+    rc = writeHeader();
+  } else {
+    rc = readHeader();
+  }
+  if (rc == 0 && format == COLUMNAR) {
+    // the values are in their own file
+    rc = vf.open(sideFileName(filename, ".val"), mode);
+  }
+  if (rc < 0) {
+    pf.close();
+    return rc;
+  }
+
+  // the number of records in a page depends on the page size of the file
+  firstPid = (format == FIXED) ? 0 : 1;
+  switch (format) {
+  case FIXED:
+    recordsPerPage = slotsPerPage(pf.getPageSize());
+    break;
+  case SLOTTED:
+    recordsPerPage = slottedPerPage(pf.getPageSize());
+    break;
+  case COLUMNAR:
+    recordsPerPage = keysPerPage(pf.getPageSize());
+    break;
+  }
   
   //
   // in the rest of this function, we set the end record id
@@ -129,100 +255,535 @@ RC RecordFile::open(const string& filename, char mode)
   // get the end pid of the file
   erid.pid = pf.endPid();
 
-  // if the end pid is zero, the file is empty.
-  // set the end record id to (0, 0).
-  if (erid.pid == 0) {
+  // if there is no page with records, the file is empty.
+  // set the end record id to the first slot of the first page.
+  if (erid.pid <= firstPid) {
+    erid.pid = firstPid;
     erid.sid = 0;
-    return 0;
+  } else {
+    // obtain # records in the last page to set sid of the end record id.
+    // read the last page of the file and get # records in the page.
+    // remeber that the id of the last page is endPid()-1 not endPid().
+    if ((rc = pf.read(--erid.pid, page)) < 0) {
+      // an error occurred during page read
+      erid.pid = erid.sid = 0;
+      close();
+      return rc;
+    }
+
+    // get # records in the last page
+    erid.sid = getRecordCount(page);
+    if (format != SLOTTED && erid.sid >= recordsPerPage) {
+      // the last page is full. advance the end record id to the next page.
+      erid.pid++;
+      erid.sid = 0;
+    }
   }
 
-  // obtain # records in the last page to set sid of the end record id.
-  // read the last page of the file and get # records in the page.
-  // remeber that the id of the last page is endPid()-1 not endPid().
-  if ((rc = pf.read(--erid.pid, page)) < 0) {
-    // an error occurred during page read
-    erid.pid = erid.sid = 0;
-    pf.close();
+  // the key ranges of the pages are in the zone map file
+  if ((rc = openZoneMap(filename, mode)) < 0) {
+    close();
     return rc;
   }
+  
+  return 0;
+}
 
-  // get # records in the last page
-  erid.sid = getRecordCount(page);
-  if (erid.sid >= RECORDS_PER_PAGE) {
-    // the last page is full. advance the end record id to the next page.
-    erid.pid++;
-    erid.sid = 0;
+RC RecordFile::openZoneMap(const string& filename, char mode)
+{
+  RC   rc;
+  char page[PageFile::MAX_PAGE_SIZE];
+  int  entries = 0;
+
+  // a file without the zone map is scanned without skipping pages
+  zoned = false;
+  if (zf.open(sideFileName(filename, ".zmp"), mode) < 0) return 0;
+
+  if (zf.endPid() > 0) {
+    if ((rc = zf.read(0, page)) < 0) {
+      zf.close();
+      return rc;
+    }
+    entries = getRecordCount(page);
   }
-  
+
+  // the zone map can be used only if it has an entry for every page with
+  // records. a file open for writing gets its zone map rebuilt otherwise
+  zoned = zf.endPid() > 0 && entries == erid.pid - firstPid + (erid.sid > 0 ? 1 : 0);
+  if (!zoned && (mode == 'w' || mode == 'W')) return buildZoneMap();
+  if (!zoned) zf.close();
+
   return 0;
 }
 
+RC RecordFile::buildZoneMap()
+{
+  RC  rc;
+  int entries = 0;
+
+  // collect the key range of every page with records
+  {
+    Scanner scanner(*this, false);
+    while ((rc = scanner.next()) == 0) {
+      const int* keys = scanner.keys();
+      int minKey = keys[0], maxKey = keys[0];
+      for (int i = 1; i < scanner.count(); i++) {
+        if (keys[i] < minKey) minKey = keys[i];
+        if (keys[i] > maxKey) maxKey = keys[i];
+      }
+
+      entries = scanner.rid(0).pid - firstPid;
+      if ((rc = writeZone(entries++, minKey, maxKey)) < 0) break;
+    }
+  }
+  if (rc == RC_END_OF_FILE) rc = writeZoneCount(entries);
+  if (rc < 0) {
+    zf.close();
+    return rc;
+  }
+
+  zoned = true;
+  return 0;
+}
+
+RC RecordFile::updateZoneMap(PageId pid, int key)
+{
+  RC   rc;
+  char page[PageFile::MAX_PAGE_SIZE];
+  int  entries, minKey, maxKey;
+
+  if ((rc = zf.read(0, page)) < 0) return rc;
+  entries = getRecordCount(page);
+
+  // the first record of a page starts a new entry
+  int n = pid - firstPid;
+  if (n >= entries) {
+    if ((rc = writeZone(n, key, key)) < 0) return rc;
+    return writeZoneCount(n + 1);
+  }
+
+  // the entry of the page changes only with a new smallest or largest key
+  if (!getPageKeyRange(pid, minKey, maxKey)) return RC_INVALID_FILE_FORMAT;
+  if (key >= minKey && key <= maxKey) return 0;
+  if (key < minKey) minKey = key;
+  if (key > maxKey) maxKey = key;
+  return writeZone(n, minKey, maxKey);
+}
+
+RC RecordFile::writeZone(int n, int minKey, int maxKey)
+{
+  RC     rc;
+  char   page[PageFile::MAX_PAGE_SIZE];
+  int    perPage = zonesPerPage(zf.getPageSize());
+  PageId zpid = 1 + n / perPage;
+
+  if (zpid < zf.endPid()) {
+    if ((rc = zf.read(zpid, page)) < 0) return rc;
+  } else {
+    memset(page, 0, zf.getPageSize());
+  }
+
+  setZone(page, n % perPage, minKey, maxKey);
+  return zf.write(zpid, page);
+}
+
+RC RecordFile::writeZoneCount(int entries)
+{
+  char page[PageFile::MAX_PAGE_SIZE];
+
+  // the first page of the zone map holds # entries
+  memset(page, 0, zf.getPageSize());
+  setRecordCount(page, entries);
+  return zf.write(0, page);
+}
+
+bool RecordFile::getPageKeyRange(PageId pid, int& minKey, int& maxKey) const
+{
+  const char* page;
+  int    perPage;
+  int    n = pid - firstPid;
+
+  if (!zoned || n < 0 || pid > erid.pid) return false;
+
+  perPage = zonesPerPage(zf.getPageSize());
+  PageId zpid = 1 + n / perPage;
+  if (zpid >= zf.endPid() || zf.pin(zpid, page) < 0) return false;
+
+  getZone(page, n % perPage, minKey, maxKey);
+  zf.unpin(zpid);
+  return true;
+}
+
+RC RecordFile::readHeader()
+{
+  RC   rc;
+  char page[PageFile::MAX_PAGE_SIZE];
+  TableHeader header;
+
+  // an empty file or a file without the header page is FIXED
+  format = FIXED;
+  if (pf.endPid() == 0) return 0;
+
+  if ((rc = pf.read(0, page)) < 0) return rc;
+  memcpy(&header, page, sizeof(header));
+  if (header.magic != TABLE_MAGIC) return 0;
+
+  if (header.format != SLOTTED && header.format != COLUMNAR) return RC_INVALID_FILE_FORMAT;
+  format = (Format)header.format;
+
+  return 0;
+}
+
+RC RecordFile::writeHeader()
+{
+  char page[PageFile::MAX_PAGE_SIZE];
+  TableHeader header;
+
+  header.magic = TABLE_MAGIC;
+  header.format = format;
+
+  memset(page, 0, pf.getPageSize());
+  memcpy(page, &header, sizeof(header));
+  return pf.write(0, page);
+}
+
 RC RecordFile::close()
 {
   erid.pid = 0;
   erid.sid = 0;
 
+  if (format == COLUMNAR) vf.close();
+  if (zoned) zf.close();
+  zoned = false;
   return pf.close();
 }
 
 RC RecordFile::read(const RecordId& rid, int& key, string& value) const
 {
   RC   rc;
-  char page[PageFile::PAGE_SIZE];
+  char buffer[MAX_VALUE_LENGTH];
+
+  if ((rc = read(rid, key, buffer)) < 0) return rc;
+  value.assign(buffer);
+
+  return 0;
+}
+
+RC RecordFile::read(const RecordId& rid, int& key, char* value) const
+{
+  RC   rc;
+  const char* page;
   
   // check whether the rid is in the valid range
-  if (rid.pid < 0 || rid.pid > erid.pid) return RC_INVALID_RID;
-  if (rid.sid < 0 || rid.sid >= RecordFile::RECORDS_PER_PAGE) return RC_INVALID_RID;
+  if (rid.pid < firstPid || rid.pid > erid.pid) return RC_INVALID_RID;
+  if (rid.sid < 0 || rid.sid >= recordsPerPage) return RC_INVALID_RID;
   if (rid >= erid) return RC_INVALID_RID;
   
-  // read the page containing the record
-  if ((rc = pf.read(rid.pid, page)) < 0) return rc;
+  // pin the page containing the record in the buffer pool
+  if ((rc = pf.pin(rid.pid, page)) < 0) return rc;
 
-  // read the record from the slot in the page
-  readSlot(page, rid.sid, key, value);
+  // read the key from the slot in the page, and the value only if asked
+  if (format == FIXED) {
+    const char* v = readSlot(page, rid.sid, key);
+    if (value != NULL) copyValue(value, v);
+  } else if (rid.sid >= getRecordCount(page)) {
+    rc = RC_INVALID_RID;
+  } else if (format == SLOTTED) {
+    Slot slot;
+    slottedGetSlot(page, rid.sid, slot);
+    key = slot.key;
+    if (value != NULL) copyValue(value, page + slot.offset);
+  } else {
+    // the value of a COLUMNAR record is found through the key page
+    PageId vpid = keyPageValuePid(page);
+    key = keyPageKeys(page)[rid.sid];
+    pf.unpin(rid.pid);
+    if (value == NULL) return 0;
+    return readColumnValue(vf, vpid, (rid.pid - firstPid) * recordsPerPage + rid.sid, value);
+  }
+  pf.unpin(rid.pid);
 
-  return 0;
+  return rc;
+}
+
+RC RecordFile::prefetch(const RecordId& rid) const
+{
+  if (rid.pid < firstPid || rid >= erid) return RC_INVALID_RID;
+
+  return pf.readAsync(rid.pid);
 }
 
 RC RecordFile::append(int key, const std::string& value, RecordId& rid)
 {
   RC   rc;
-  char page[PageFile::PAGE_SIZE];
+  char page[PageFile::MAX_PAGE_SIZE];
+
+  // a SLOTTED page is full when the value does not fit in its free space
+  int length = value.size();
+  if (length >= MAX_VALUE_LENGTH) length = MAX_VALUE_LENGTH - 1;
+  int needed = sizeof(Slot) + length + 1;
+
+  // the value of a COLUMNAR record goes to the end of the value file.
+  // a new key page points to the value page of its first value
+  PageId vpid = -1;
+  if (format == COLUMNAR) {
+    char vpage[PageFile::MAX_PAGE_SIZE];
+    int  row = (erid.pid - firstPid) * recordsPerPage + erid.sid;
+
+    vpid = vf.endPid() - 1;
+    if (vpid >= 0) {
+      if ((rc = vf.read(vpid, vpage)) < 0) return rc;
+    }
+    if (vpid < 0 || valuePageFreeSpace(vpage) < (int)sizeof(unsigned short) + length + 1) {
+      vpid++;
+      valuePageInit(vpage, vf.getPageSize(), row);
+    }
+    valuePageAppend(vpage, value.c_str(), length);
+    if ((rc = vf.write(vpid, vpage)) < 0) return rc;
+  }
 
   // unless we are writing to the the first slot of an empty page,
   // we have to read the page first
   if (erid.sid > 0) {
     if ((rc = pf.read(erid.pid, page)) < 0) return rc;
-  } else {
+    if (format == SLOTTED && slottedFreeSpace(page) < needed) {
+      erid.pid++;
+      erid.sid = 0;
+    }
+  }
+  if (erid.sid == 0) {
     // if this is the first slot of an empty page
     // we can simply initialize the page with zeros
-    memset(page, 0, PageFile::PAGE_SIZE);
+    memset(page, 0, pf.getPageSize());
+    if (format == SLOTTED) slottedInit(page, pf.getPageSize());
+    if (format == COLUMNAR) keyPageInit(page, vpid);
   }
     
   // write the record to the first empty slot 
-  writeSlot(page, erid.sid, key, value);
+  if (format == SLOTTED) {
+    slottedAppend(page, key, value.c_str(), length);
+  } else {
+    if (format == FIXED) {
+      writeSlot(page, erid.sid, key, value);
+    } else {
+      memcpy(page + 2 * sizeof(int) + erid.sid * sizeof(int), &key, sizeof(int));
+    }
 
-  // the first four bytes in the page stores # records in the page.
-  // update this number.
-  setRecordCount(page, erid.sid + 1);
+    // the first four bytes in the page stores # records in the page.
+    // update this number.
+    setRecordCount(page, erid.sid + 1);
+  }
 
   // write the page to the disk
   if ((rc = pf.write(erid.pid, page)) < 0) return rc;
     
+  // keep the key range of the page up to date
+  if (zoned && (rc = updateZoneMap(erid.pid, key)) < 0) return rc;
+
   // we need to output the rid of the record slot
   rid = erid;
 
-  // advance the end record id by one to the next empty slot
-  ++erid;
+  // advance the end record id by one to the next empty slot.
+  // if the end of a FIXED or COLUMNAR page is reached, move to the next page
+  if (++erid.sid >= recordsPerPage && format != SLOTTED) {
+    erid.pid++;
+    erid.sid = 0;
+  }
 
   return 0;
 }
 
+void RecordFile::advise(PageFile::AccessPattern pattern) const
+{
+  pf.advise(pattern);
+  if (format == COLUMNAR) vf.advise(pattern);
+}
+
 const RecordId& RecordFile::endRid() const
 {
   return erid;
 }
 
+RecordFile::Scanner::Scanner(const RecordFile& file, bool vals)
+  : rf(file), withValues(vals), ranged(false), low(0), high(0),
+    pid(file.firstPid - 1), stop(file.erid.pid + 1), page(NULL), stored(0),
+    first(0), n(0), vpid(-1), vpage(NULL), keyPtr(NULL),
+    keyBuf(file.recordsPerPage), valueBuf(file.recordsPerPage)
+{
+}
+
+RecordFile::Scanner::~Scanner()
+{
+  release();
+}
+
+void RecordFile::Scanner::setKeyRange(int lowKey, int highKey)
+{
+  ranged = true;
+  low = lowKey;
+  high = highKey;
+}
+
+void RecordFile::Scanner::setPart(int part, int parts)
+{
+  // split the pages [firstPid, erid.pid] into parts ranges of about
+  // the same size. the pages are counted in 64 bits not to overflow
+  long long total = rf.erid.pid + 1 - rf.firstPid;
+  pid = rf.firstPid + (PageId)(total * part / parts) - 1;
+  stop = rf.firstPid + (PageId)(total * (part + 1) / parts);
+}
+
+void RecordFile::Scanner::release()
+{
+  if (page != NULL) {
+    rf.pf.unpin(pid);
+    page = NULL;
+  }
+  if (vpage != NULL) {
+    rf.vf.unpin(vpid);
+    vpage = NULL;
+  }
+  n = 0;
+}
+
+RC RecordFile::Scanner::next()
+{
+  RC rc;
+
+  // move to the next page once all records of the page are returned
+  first += n;
+  n = 0;
+  if (page == NULL || first >= stored) {
+    if ((rc = nextPage()) < 0) return rc;
+  }
+
+  switch (rf.format) {
+  case FIXED: {
+    // the values are located only if they are needed
+    char* ptr = slotPtr(const_cast<char*>(page), 0);
+    for (int i = 0; i < stored; i++) {
+      memcpy(&keyBuf[i], ptr, sizeof(int));
+      ptr += sizeof(int) + RecordFile::MAX_VALUE_LENGTH;
+    }
+    if (withValues) {
+      ptr = slotPtr(const_cast<char*>(page), 0) + sizeof(int);
+      for (int i = 0; i < stored; i++) {
+        valueBuf[i] = ptr;
+        ptr += sizeof(int) + RecordFile::MAX_VALUE_LENGTH;
+      }
+    }
+    keyPtr = &keyBuf[0];
+    n = stored;
+    break;
+  }
+  case SLOTTED: {
+    Slot slot;
+    for (int i = 0; i < stored; i++) {
+      slottedGetSlot(page, i, slot);
+      keyBuf[i] = slot.key;
+      if (withValues) valueBuf[i] = page + slot.offset;
+    }
+    keyPtr = &keyBuf[0];
+    n = stored;
+    break;
+  }
+  case COLUMNAR:
+    // the keys are used right in the page
+    keyPtr = keyPageKeys(page) + first;
+    if (withValues) return nextValues();
+    n = stored - first;
+    break;
+  }
+
+  return 0;
+}
+
+RC RecordFile::Scanner::nextPage()
+{
+  RC rc;
+
+  if (page != NULL) {
+    rf.pf.unpin(pid);
+    page = NULL;
+  }
+  first = 0;
+
+  // the pages before erid.pid hold at most recordsPerPage records.
+  // the page of erid holds erid.sid records
+  while (++pid < stop) {
+    int count = (pid < rf.erid.pid) ? rf.recordsPerPage : rf.erid.sid;
+    if (count == 0) continue;
+
+    // skip the page if the zone map tells that no key is in the range
+    int minKey, maxKey;
+    if (ranged && rf.getPageKeyRange(pid, minKey, maxKey) && (maxKey < low || minKey > high)) {
+      continue;
+    }
+
+    if ((rc = rf.pf.pin(pid, page)) < 0) {
+      page = NULL;
+      return rc;
+    }
+
+    // a SLOTTED page may hold fewer records than the maximum.
+    // a page of the other formats only if it is damaged
+    stored = getRecordCount(page);
+    if (stored < 0 || stored > count) stored = count;
+    if (stored > 0) return 0;
+
+    rf.pf.unpin(pid);
+    page = NULL;
+  }
+
+  pid = stop - 1;
+  return RC_END_OF_FILE;
+}
+
+RC RecordFile::Scanner::nextValues()
+{
+  RC  rc;
+  int row = (pid - rf.firstPid) * rf.recordsPerPage + first;
+  int vfirst, vcount;
+
+  // the value of the row is in the pinned value page or in a later one.
+  // the key page knows the value page of its first row
+  PageId next = keyPageValuePid(page);
+  for (;;) {
+    if (vpage != NULL) {
+      valuePageRange(vpage, vfirst, vcount);
+      if (row >= vfirst && row < vfirst + vcount) break;
+
+      rf.vf.unpin(vpid);
+      vpage = NULL;
+      if (row < vfirst) return RC_INVALID_FILE_FORMAT;
+      if (vpid + 1 > next) next = vpid + 1;
+    }
+    if (next >= rf.vf.endPid()) return RC_INVALID_FILE_FORMAT;
+
+    if ((rc = rf.vf.pin(next, vpage)) < 0) {
+      vpage = NULL;
+      return rc;
+    }
+    vpid = next;
+  }
+
+  // the batch ends with the key page or with the value page
+  n = stored - first;
+  if (n > vfirst + vcount - row) n = vfirst + vcount - row;
+  for (int i = 0; i < n; i++) {
+    valueBuf[i] = valuePageValue(vpage, row - vfirst + i);
+  }
+
+  return 0;
+}
+
+static int slotsPerPage(int pageSize)
+{
+  // we subtract sizeof(int) from the page size because the first
+  // four bytes in the page is used to store # records in the page.
+  return (pageSize - sizeof(int)) / (sizeof(int) + RecordFile::MAX_VALUE_LENGTH);
+}
+
 static int getRecordCount(const char* page)
 {
   int count;
@@ -247,7 +808,7 @@ static char* slotPtr(char* page, int n)
   return (page+sizeof(int)) + (sizeof(int)+RecordFile::MAX_VALUE_LENGTH)*n;
 }
 
-static void readSlot(const char* page, int n, int& key, std::string& value)
+static const char* readSlot(const char* page, int n, int& key)
 {
   // compute the location of the record
   char *ptr = slotPtr(const_cast<char*>(page), n);
@@ -255,8 +816,16 @@ static void readSlot(const char* page, int n, int& key, std::string& value)
   // read the key 
   memcpy(&key, ptr, sizeof(int));
 
-  // read the value
-  value.assign(ptr + sizeof(int));
+  // the value follows the key
+  return ptr + sizeof(int);
+}
+
+static void copyValue(char* buffer, const char* value)
+{
+  // the values are stored null-terminated, but a damaged page must not
+  // overflow the buffer
+  strncpy(buffer, value, RecordFile::MAX_VALUE_LENGTH - 1);
+  buffer[RecordFile::MAX_VALUE_LENGTH - 1] = 0;
 }
 
 static void writeSlot(char* page, int n, int key, const std::string& value)
@@ -276,3 +845,194 @@ static void writeSlot(char* page, int n, int key, const std::string& value)
     strcpy(ptr + sizeof(int), value.c_str());
   }
 }
+
+static int slottedPerPage(int pageSize)
+{
+  // the smallest record is a slot and the null of an empty value
+  return (pageSize - 2 * sizeof(int)) / (sizeof(Slot) + 1);
+}
+
+static int slottedFreeSpace(const char* page)
+{
+  int count, freeEnd;
+
+  memcpy(&count, page, sizeof(int));
+  memcpy(&freeEnd, page + sizeof(int), sizeof(int));
+  return freeEnd - (int)(2 * sizeof(int) + count * sizeof(Slot));
+}
+
+static void slottedInit(char* page, int pageSize)
+{
+  int count = 0;
+
+  // the free space spans the whole page after the page header
+  memcpy(page, &count, sizeof(int));
+  memcpy(page + sizeof(int), &pageSize, sizeof(int));
+}
+
+static void slottedGetSlot(const char* page, int n, Slot& slot)
+{
+  memcpy(&slot, page + 2 * sizeof(int) + n * sizeof(Slot), sizeof(Slot));
+}
+
+static void slottedAppend(char* page, int key, const char* value, int length)
+{
+  int  count, freeEnd;
+  Slot slot;
+
+  memcpy(&count, page, sizeof(int));
+  memcpy(&freeEnd, page + sizeof(int), sizeof(int));
+
+  // store the value with its null at the end of the free space
+  freeEnd -= length + 1;
+  memcpy(page + freeEnd, value, length);
+  page[freeEnd + length] = 0;
+
+  // add the slot to the end of the directory
+  slot.key = key;
+  slot.offset = freeEnd;
+  slot.length = length;
+  memcpy(page + 2 * sizeof(int) + count * sizeof(Slot), &slot, sizeof(Slot));
+
+  count++;
+  memcpy(page, &count, sizeof(int));
+  memcpy(page + sizeof(int), &freeEnd, sizeof(int));
+}
+
+static int keysPerPage(int pageSize)
+{
+  // the first eight bytes hold # keys and the value page of the first row
+  return (pageSize - 2 * sizeof(int)) / sizeof(int);
+}
+
+static const int* keyPageKeys(const char* page)
+{
+  return (const int*)(page + 2 * sizeof(int));
+}
+
+static PageId keyPageValuePid(const char* page)
+{
+  PageId vpid;
+
+  memcpy(&vpid, page + sizeof(int), sizeof(PageId));
+  return vpid;
+}
+
+static void keyPageInit(char* page, PageId vpid)
+{
+  setRecordCount(page, 0);
+  memcpy(page + sizeof(int), &vpid, sizeof(PageId));
+}
+
+static void valuePageRange(const char* page, int& firstRow, int& count)
+{
+  memcpy(&firstRow, page, sizeof(int));
+  memcpy(&count, page + sizeof(int), sizeof(int));
+}
+
+static int valuePageFreeSpace(const char* page)
+{
+  int count, freeEnd;
+
+  memcpy(&count, page + sizeof(int), sizeof(int));
+  memcpy(&freeEnd, page + 2 * sizeof(int), sizeof(int));
+  return freeEnd - (int)(3 * sizeof(int) + count * sizeof(unsigned short));
+}
+
+static const char* valuePageValue(const char* page, int n)
+{
+  unsigned short offset;
+
+  memcpy(&offset, page + 3 * sizeof(int) + n * sizeof(unsigned short), sizeof(offset));
+  return page + offset;
+}
+
+static void valuePageInit(char* page, int pageSize, int firstRow)
+{
+  int count = 0;
+
+  memset(page, 0, pageSize);
+  memcpy(page, &firstRow, sizeof(int));
+  memcpy(page + sizeof(int), &count, sizeof(int));
+  memcpy(page + 2 * sizeof(int), &pageSize, sizeof(int));
+}
+
+static void valuePageAppend(char* page, const char* value, int length)
+{
+  int count, freeEnd;
+  unsigned short offset;
+
+  memcpy(&count, page + sizeof(int), sizeof(int));
+  memcpy(&freeEnd, page + 2 * sizeof(int), sizeof(int));
+
+  // store the value with its null at the end of the free space
+  freeEnd -= length + 1;
+  memcpy(page + freeEnd, value, length);
+  page[freeEnd + length] = 0;
+
+  // add its offset after the other offsets
+  offset = freeEnd;
+  memcpy(page + 3 * sizeof(int) + count * sizeof(unsigned short), &offset, sizeof(offset));
+
+  count++;
+  memcpy(page + sizeof(int), &count, sizeof(int));
+  memcpy(page + 2 * sizeof(int), &freeEnd, sizeof(int));
+}
+
+static RC readColumnValue(const PageFile& vf, PageId vpid, int row, char* value)
+{
+  RC     rc;
+  const char* page;
+  int    firstRow, count;
+  PageId low = vpid, high = vf.endPid() - 1;
+
+  // the value is in a page between vpid and the last page. the pages
+  // hold about the same # values, so the next guess is interpolated from
+  // the rows of the page just read
+  while (low <= high) {
+    if ((rc = vf.pin(vpid, page)) < 0) return rc;
+    valuePageRange(page, firstRow, count);
+    if (row >= firstRow && row < firstRow + count) {
+      copyValue(value, valuePageValue(page, row - firstRow));
+      vf.unpin(vpid);
+      return 0;
+    }
+    vf.unpin(vpid);
+
+    if (row < firstRow) high = vpid - 1;
+    else low = vpid + 1;
+    if (count <= 0) count = 1;
+    vpid += (row - firstRow) / count;
+    if (vpid < low) vpid = low;
+    if (vpid > high) vpid = high;
+  }
+
+  return RC_INVALID_FILE_FORMAT;
+}
+
+static int zonesPerPage(int pageSize)
+{
+  return pageSize / (2 * sizeof(int));
+}
+
+static void getZone(const char* page, int n, int& minKey, int& maxKey)
+{
+  memcpy(&minKey, page + 2 * n * sizeof(int), sizeof(int));
+  memcpy(&maxKey, page + (2 * n + 1) * sizeof(int), sizeof(int));
+}
+
+static void setZone(char* page, int n, int minKey, int maxKey)
+{
+  memcpy(page + 2 * n * sizeof(int), &minKey, sizeof(int));
+  memcpy(page + (2 * n + 1) * sizeof(int), &maxKey, sizeof(int));
+}
+
+static std::string sideFileName(const std::string& filename, const char* ext)
+{
+  // table.tbl is stored with table.val and table.zmp
+  std::string::size_type len = filename.size();
+  if (len > 4 && filename.compare(len - 4, 4, ".tbl") == 0) {
+    return filename.substr(0, len - 4) + ext;
+  }
+  return filename + ext;
+}
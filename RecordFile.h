@@ -11,6 +11,7 @@
 #define RECORDFILE_H
 
 #include <string>
+#include <vector>
 #include "PageFile.h"
 
 /**
@@ -26,10 +27,6 @@ typedef struct {
 // helper functions for RecordId
 // 
 
-// RecordId iterators
-RecordId& operator++ (RecordId& rid);
-RecordId  operator++ (RecordId& rid, int);
-
 // RecordId comparators
 bool operator> (const RecordId& r1, const RecordId& r2);
 bool operator< (const RecordId& r1, const RecordId& r2);
@@ -47,22 +44,35 @@ class RecordFile {
   // maximum length of the value field
   static const int MAX_VALUE_LENGTH = 100;  
 
-  // number of record slots per page
-  static const int RECORDS_PER_PAGE = (PageFile::PAGE_SIZE - sizeof(int))/ (sizeof(int) + MAX_VALUE_LENGTH);  
-    // Note that we subtract sizeof(int) from PAGE_SIZE because the first
-    // four bytes in the page is used to store # records in the page.
+  /**
+   * the layout of the records in the pages of a file.
+   * FIXED stores every record in a slot of MAX_VALUE_LENGTH + 4 bytes.
+   * SLOTTED keeps a directory of the keys at the beginning of a page and
+   * stores the values with their actual length at the end of the page.
+   * COLUMNAR packs the keys of consecutive rows into the pages of the file
+   * and stores the values in the pages of a separate value file, so that
+   * the values are not read when only the keys are needed. the record
+   * with id (pid, sid) is row (pid - 1) * getRecordsPerPage() + sid.
+   * SLOTTED and COLUMNAR files start with a header page, so their
+   * records begin at page 1
+   */
+  enum Format { FIXED, SLOTTED, COLUMNAR };
 
   RecordFile();
   RecordFile(const std::string& filename, char mode);
   
   /**
    * open a file in read or write mode.
-   * when opened in 'w' mode, if the file does not exist, it is created.
+   * when opened in 'w' mode, if the file does not exist, it is created
+   * with the given format. an existing file keeps the format it has.
+   * the values of a COLUMNAR file are stored in the file with the same
+   * name and the extension .val instead of .tbl, which is opened with it.
    * @param filename[IN] the name of the file to open
-   * @param mode[IN] 'r' for read, 'w' for write
+   * @param mode[IN] 'r' for read, 'w' for write, 'm' for memory-mapped read
+   * @param format[IN] the format of the file if it is created
    * @return error code. 0 if no error
    */
-  RC open(const std::string& filename, char mode);
+  RC open(const std::string& filename, char mode, Format format = FIXED);
 
   /**
    * close the file.
@@ -79,6 +89,26 @@ class RecordFile {
    */
   RC read(const RecordId& rid, int& key, std::string& value) const;
 
+  /**
+   * read a record without building a string. the key is decoded first
+   * and the value is copied only if a buffer is given.
+   * @param rid[IN] the id of the record to read
+   * @param key[OUT] the record key
+   * @param value[OUT] a buffer of MAX_VALUE_LENGTH bytes for the record
+   *                   value, or NULL if only the key is needed
+   * @return error code. 0 if no error
+   */
+  RC read(const RecordId& rid, int& key, char* value) const;
+
+  /**
+   * start reading the page of a record in the background, so that a
+   * later read() of the record does not have to wait for the disk.
+   * the read is issued by the next PageFile::submit().
+   * @param rid[IN] the id of the record that is going to be read
+   * @return error code. 0 if no error
+   */
+  RC prefetch(const RecordId& rid) const;
+
   /**
    * append a new record at the end of the file.
    * note that RecordFile does not have write() function.
@@ -90,15 +120,160 @@ class RecordFile {
    */
   RC append(int key, const std::string& value, RecordId& rid);
 
+  /**
+   * @return the format of the file
+   */
+  Format getFormat() const { return format; }
+
+  /**
+   * @return the largest number of records in a page of the file.
+   *         it depends on the format and the page size of the file
+   */
+  int getRecordsPerPage() const { return recordsPerPage; }
+
+  /**
+   * get the smallest and the largest key of the records in a page.
+   * the key ranges of the pages are kept in a zone map file next to the
+   * table file (extension .zmp instead of .tbl). append() keeps it up to
+   * date, and it is rebuilt when a file without an up-to-date zone map
+   * is opened in 'w' mode.
+   * @param pid[IN] the page
+   * @param minKey[OUT] the smallest key in the page
+   * @param maxKey[OUT] the largest key in the page
+   * @return true if the key range of the page is known
+   */
+  bool getPageKeyRange(PageId pid, int& minKey, int& maxKey) const;
+
+  /**
+   * tell the operating system how the records are going to be accessed.
+   * @param pattern[IN] SEQUENTIAL for a table scan,
+   *                    RANDOM for record lookups through an index
+   */
+  void advise(PageFile::AccessPattern pattern) const;
+
   /**
    * note the +1 part. The rid of the last record is endRid()-1.
    * @return (last record id + 1) of the RecordFile
    */
   const RecordId& endRid() const;
 
+  /**
+   * Scanner reads the records of a RecordFile a batch at a time.
+   * next() pins the next page of the file in the buffer pool once and
+   * makes the records of the page available as a batch: the keys are an
+   * array and the values are pointers into the pinned page. the pointers
+   * stay valid until the next call to next() or until the scanner is
+   * destroyed. a batch of a COLUMNAR file ends where its value page ends,
+   * so a key page may be returned in several batches.
+   */
+  class Scanner {
+   public:
+    /**
+     * create a scanner positioned before the first page of the file.
+     * @param rf[IN] the open RecordFile to scan
+     * @param values[IN] false if only the keys are needed. the values
+     *                   of a COLUMNAR file are then not read at all
+     */
+    Scanner(const RecordFile& rf, bool values = true);
+    ~Scanner();
+
+    /**
+     * move to the next batch of records.
+     * @return error code. 0 if no error.
+     *         RC_END_OF_FILE if there is no more record
+     */
+    RC next();
+
+    /**
+     * skip the pages whose keys are all outside [low, high] according to
+     * the zone map of the file. the batches of the other pages may still
+     * have keys outside the range.
+     * @param low[IN] the smallest key of interest
+     * @param high[IN] the largest key of interest
+     */
+    void setKeyRange(int low, int high);
+
+    /**
+     * scan only the part-th of parts disjoint ranges of pages of the file,
+     * so that the file can be scanned by parts scanners at the same time.
+     * must be called before the first next().
+     * @param part[IN] the range of pages to scan (0 .. parts-1)
+     * @param parts[IN] # ranges the pages are split into
+     */
+    void setPart(int part, int parts);
+
+    /**
+     * @return # records in the current batch
+     */
+    int count() const { return n; }
+
+    /**
+     * @return the keys of the records in the current batch
+     */
+    const int* keys() const { return keyPtr; }
+
+    /**
+     * the values are available only if the scanner was created with values.
+     * @param i[IN] the position of the record in the current batch
+     * @return the value of the record as a null-terminated string
+     */
+    const char* value(int i) const { return valueBuf[i]; }
+
+    /**
+     * the values are available only if the scanner was created with values.
+     * @return the values of the records in the current batch
+     */
+    const char* const* values() const { return &valueBuf[0]; }
+
+    /**
+     * @param i[IN] the position of the record in the current batch
+     * @return the id of the record
+     */
+    RecordId rid(int i) const { RecordId r; r.pid = pid; r.sid = first + i; return r; }
+
+   private:
+    Scanner(const Scanner&);
+    Scanner& operator=(const Scanner&);
+
+    RC   nextPage();
+    RC   nextValues();
+    void release();
+
+    const RecordFile& rf;
+    bool        withValues; // are the values needed?
+    bool        ranged;   // are the pages outside [low, high] skipped?
+    int         low;
+    int         high;
+    PageId      pid;      // the current page. before the first page initially
+    PageId      stop;     // the page after the last page to scan
+    const char* page;     // the pinned current page. NULL if none
+    int         stored;   // # records in the current page
+    int         first;    // the slot of the first record of the batch
+    int         n;        // # records in the batch
+    PageId      vpid;     // the pinned value page of a COLUMNAR file
+    const char* vpage;    // NULL if none
+    const int*  keyPtr;   // the keys of the batch
+    std::vector<int>         keyBuf;    // the keys copied out of a page
+    std::vector<const char*> valueBuf;  // the values of the batch
+  };
+
  private:
   PageFile pf;     // the PageFile used to store the records
+  PageFile vf;     // the PageFile used to store the values of a COLUMNAR file
+  PageFile zf;     // the zone map of the file
+  bool     zoned;  // is the zone map open and up to date?
   RecordId erid;   // the last record id of the file + 1
+  Format   format; // the layout of the records in the pages
+  PageId   firstPid;       // the first page with records
+  int      recordsPerPage; // the largest number of records in a page
+
+  RC readHeader();
+  RC writeHeader();
+  RC openZoneMap(const std::string& filename, char mode);
+  RC buildZoneMap();
+  RC updateZoneMap(PageId pid, int key);
+  RC writeZone(int n, int minKey, int maxKey);
+  RC writeZoneCount(int entries);
 };
 
 #endif // RECORDFILE_H
@@ -0,0 +1,218 @@
+/*
+ * ResultWriter: the buffered output of the tuples returned by a SELECT.
+ */
+
+#include "ResultWriter.h"
+#include <cstring>
+
+ResultWriter::ResultWriter(Mode m, FILE* f)
+  : mode(m), out(f), rowStart(0), columns(0), column(0)
+{
+  // the buffer goes a tuple beyond BUFFER_SIZE before it is written out
+  if (out != NULL) buffer.reserve(2 * BUFFER_SIZE);
+}
+
+ResultWriter::~ResultWriter()
+{
+  flush();
+}
+
+void ResultWriter::putInt(long long v)
+{
+  char  digits[24];
+  char* p = digits + sizeof(digits);
+
+  // the digits come out from the last one. the magnitude is taken as
+  // unsigned, so that the smallest integer does not overflow
+  unsigned long long u = (v < 0) ? 0ull - (unsigned long long)v : (unsigned long long)v;
+  do {
+    *--p = '0' + u % 10;
+    u /= 10;
+  } while (u != 0);
+  if (v < 0) *--p = '-';
+
+  buffer.append(p, digits + sizeof(digits) - p);
+}
+
+void ResultWriter::putBinaryInt(int v)
+{
+  unsigned u = (unsigned)v;
+  char bytes[4] = { (char)u, (char)(u >> 8), (char)(u >> 16), (char)(u >> 24) };
+  buffer.append(bytes, 4);
+}
+
+void ResultWriter::putBinaryLong(long long v)
+{
+  unsigned long long u = (unsigned long long)v;
+  putBinaryInt((int)(unsigned)u);
+  putBinaryInt((int)(unsigned)(u >> 32));
+}
+
+void ResultWriter::putValue(const char* value)
+{
+  if (mode != TSV) {
+    buffer.append(value);
+    return;
+  }
+
+  // copy the runs of characters that need no escape at once
+  for (;;) {
+    size_t n = strcspn(value, "\t\n\\");
+    buffer.append(value, n);
+    value += n;
+    switch (*value++) {
+    case '\t': buffer.append("\\t", 2); break;
+    case '\n': buffer.append("\\n", 2); break;
+    case '\\': buffer.append("\\\\", 2); break;
+    default:   return;
+    }
+  }
+}
+
+void ResultWriter::beginRow(int n)
+{
+  columns = n;
+  column = 0;
+
+  // the length of a binary row is filled in when the row ends
+  rowStart = buffer.size();
+  if (mode == BINARY) putBinaryInt(0);
+}
+
+void ResultWriter::putSeparator()
+{
+  if (column++ == 0) return;
+  if (mode == TEXT) buffer += ' ';
+  else if (mode == TSV) buffer += '\t';
+}
+
+void ResultWriter::putColumn(int v)
+{
+  putSeparator();
+  if (mode == BINARY) putBinaryInt(v);
+  else putInt(v);
+}
+
+void ResultWriter::putColumn(long long v)
+{
+  putSeparator();
+  if (mode == BINARY) putBinaryLong(v);
+  else putInt(v);
+}
+
+void ResultWriter::putColumn(double v)
+{
+  putSeparator();
+  if (mode == BINARY) {
+    long long bits;
+    memcpy(&bits, &v, sizeof(bits));
+    putBinaryLong(bits);
+  } else {
+    char buf[32];
+    buffer.append(buf, snprintf(buf, sizeof(buf), "%.15g", v));
+  }
+}
+
+void ResultWriter::putColumn(const char* v)
+{
+  putSeparator();
+  if (mode == BINARY) {
+    int length = strlen(v);
+    putBinaryInt(length);
+    buffer.append(v, length);
+  } else if (mode == TEXT && columns > 1) {
+    buffer += '\'';
+    putValue(v);
+    buffer += '\'';
+  } else {
+    putValue(v);
+  }
+}
+
+void ResultWriter::endRow()
+{
+  if (mode == BINARY) {
+    unsigned u = buffer.size() - rowStart - 4;
+    char bytes[4] = { (char)u, (char)(u >> 8), (char)(u >> 16), (char)(u >> 24) };
+    buffer.replace(rowStart, 4, bytes, 4);
+  } else {
+    buffer += '\n';
+  }
+  if (out != NULL && buffer.size() >= BUFFER_SIZE) flush();
+}
+
+void ResultWriter::writeTuple(int attr, int key, const char* value)
+{
+  beginRow(attr == 3 ? 2 : 1);
+  if (attr == 1 || attr == 3) putColumn(key);    // SELECT key or *
+  if (attr == 2 || attr == 3) putColumn(value);  // SELECT value or *
+  endRow();
+}
+
+void ResultWriter::writeInt(int v)
+{
+  beginRow(1);
+  putColumn(v);
+  endRow();
+}
+
+void ResultWriter::writeLong(long long v)
+{
+  beginRow(1);
+  putColumn(v);
+  endRow();
+}
+
+void ResultWriter::writeDouble(double v)
+{
+  beginRow(1);
+  putColumn(v);
+  endRow();
+}
+
+void ResultWriter::writeNull()
+{
+  beginRow(1);
+  if (mode != BINARY) buffer.append("NULL", 4);
+  endRow();
+}
+
+RC ResultWriter::append(ResultWriter& other)
+{
+  RC rc;
+
+  // the result of the other writer is in its file. it is copied
+  // a chunk at a time after the tuples buffered here
+  if (other.out != NULL) {
+    char   chunk[64 * 1024];
+    size_t n;
+
+    if ((rc = other.flush()) < 0 || (rc = flush()) < 0) return rc;
+    if (fflush(other.out) != 0 || fseek(other.out, 0, SEEK_SET) != 0) return RC_FILE_SEEK_FAILED;
+    while ((n = fread(chunk, 1, sizeof(chunk), other.out)) > 0) {
+      if (out == NULL) buffer.append(chunk, n);
+      else if (fwrite(chunk, 1, n, out) != n) return RC_FILE_WRITE_FAILED;
+    }
+    return ferror(other.out) ? RC_FILE_READ_FAILED : 0;
+  }
+
+  // a large result goes out right away instead of being copied
+  rc = 0;
+  if (out != NULL && buffer.size() + other.buffer.size() >= BUFFER_SIZE) {
+    flush();
+    if (fwrite(other.buffer.data(), 1, other.buffer.size(), out) != other.buffer.size()) rc = RC_FILE_WRITE_FAILED;
+  } else {
+    buffer += other.buffer;
+  }
+  other.buffer.clear();
+  return rc;
+}
+
+RC ResultWriter::flush()
+{
+  if (out == NULL || buffer.empty()) return 0;
+
+  bool ok = fwrite(buffer.data(), 1, buffer.size(), out) == buffer.size();
+  buffer.clear();
+  return ok ? 0 : RC_FILE_WRITE_FAILED;
+}
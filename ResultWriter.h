@@ -0,0 +1,134 @@
+/*
+ * ResultWriter: the buffered output of the tuples returned by a SELECT.
+ */
+
+#ifndef RESULTWRITER_H
+#define RESULTWRITER_H
+
+#include <cstdio>
+#include <string>
+#include "Bruinbase.h"
+
+/**
+ * Formats the result tuples of a query into a large buffer, which is
+ * written out in chunks of about BUFFER_SIZE bytes. The integers are
+ * formatted by hand instead of through printf().
+ *
+ * The tuples are written in one of three formats:
+ *   TEXT:   key, 'value' or key 'value', one tuple per line
+ *   TSV:    the selected columns separated by a tab, one tuple per line.
+ *           tab, newline and backslash in a value are written as
+ *           \t, \n and \\
+ *   BINARY: every row is a 4-byte length of the rest of the row followed
+ *           by the selected columns. a key is a 4-byte integer and a value
+ *           is a 4-byte length followed by the bytes of the value without
+ *           the terminating null. all integers are little-endian
+ * The result of an aggregate is written as a row with a single column.
+ * In BINARY, count(*), min and max are 4-byte integers, sum is an 8-byte
+ * integer and avg is an 8-byte IEEE double. The aggregate of no tuple is
+ * NULL in TEXT and TSV and an empty row in BINARY.
+ *
+ * Other rows, such as the groups of a GROUP BY, are written a column at
+ * a time between beginRow() and endRow(). In TEXT, the columns are
+ * separated by a space and a value is quoted if the row has more than
+ * one column.
+ *
+ * A writer without an output file keeps the whole result in its buffer,
+ * to be appended to another writer later. A writer whose output file is
+ * a temporary file can be appended the same way.
+ */
+class ResultWriter {
+ public:
+  enum Mode { TEXT, TSV, BINARY };
+
+  static const size_t BUFFER_SIZE = 256 * 1024;
+
+  /**
+   * @param mode[IN] the format of the tuples
+   * @param out[IN] the file to write to. NULL to keep the result in the buffer
+   */
+  ResultWriter(Mode mode = TEXT, FILE* out = NULL);
+  ~ResultWriter();
+
+  /**
+   * write the selected attribute of the tuple (key, value).
+   * @param attr[IN] the attribute in the SELECT clause (1: key, 2: value, 3: *)
+   * @param key[IN] the key of the tuple
+   * @param value[IN] the value of the tuple. not used for attr 1
+   */
+  void writeTuple(int attr, int key, const char* value);
+
+  /**
+   * write the result of an aggregate that is a 4-byte integer.
+   * @param v[IN] the result
+   */
+  void writeInt(int v);
+
+  /**
+   * write the result of an aggregate that is an 8-byte integer.
+   * @param v[IN] the result
+   */
+  void writeLong(long long v);
+
+  /**
+   * write the result of an aggregate that is a real number.
+   * @param v[IN] the result
+   */
+  void writeDouble(double v);
+
+  /**
+   * write the result of an aggregate over no tuple.
+   */
+  void writeNull();
+
+  /**
+   * start a row. the columns are added with putColumn().
+   * @param columns[IN] # columns of the row
+   */
+  void beginRow(int columns);
+
+  /**
+   * add a column to the row: a 4-byte integer, an 8-byte integer,
+   * a real number or a value.
+   * @param v[IN] the column
+   */
+  void putColumn(int v);
+  void putColumn(long long v);
+  void putColumn(double v);
+  void putColumn(const char* v);
+
+  /**
+   * end the row started by beginRow().
+   */
+  void endRow();
+
+  /**
+   * append the result of another writer and empty that writer.
+   * @param other[IN/OUT] the writer without an output file or with a
+   *        temporary output file, which is copied from its start
+   * @return error code. 0 if no error
+   */
+  RC append(ResultWriter& other);
+
+  /**
+   * write the buffered result to the output file.
+   * @return error code. 0 if no error
+   */
+  RC flush();
+
+ private:
+  void putInt(long long v);
+  void putBinaryInt(int v);
+  void putBinaryLong(long long v);
+  void putValue(const char* value);
+  void putSeparator();
+
+  Mode        mode;
+  FILE*       out;     // NULL if the result is kept
+  std::string buffer;  // the formatted tuples not written out yet
+  size_t      rowStart;  // the position of the row being written in buffer
+  int         columns;   // # columns of the row
+  int         column;    // # columns written so far
+};
+
+#endif // RESULTWRITER_H
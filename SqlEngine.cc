@@ -10,12 +10,23 @@
 #include <cstdio>
 #include <cstring>
 #include <cstdlib>
+#include <climits>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <pthread.h>
+#include <unistd.h>
 #include "Bruinbase.h"
 #include "SqlEngine.h"
+#include "BTreeIndex.h"
+#include "Predicate.h"
+#include "ResultWriter.h"
+#include "HashAggregate.h"
+#include "ExternalSort.h"
+#include "TopK.h"
+#include "HashJoin.h"
+#include "IndexJoin.h"
 
 using namespace std;
 
@@ -23,10 +34,32 @@ using namespace std;
 extern FILE* sqlin;
 int sqlparse(void);
 
+// the mode used to open tables and indexes for SELECT
+static char readMode = 'r';
+
+// # tuples fetched together through an index
+static const int FETCH_BATCH = 32;
+
+// # threads that scan a table
+static int scanThreads = 1;
+
+// # pages a scan thread gets at least. smaller tables are scanned by fewer threads
+static const int MIN_PART_PAGES = 64;
+
+// the format of the tuples returned by SELECT
+static ResultWriter::Mode outputMode = ResultWriter::TEXT;
+
+// the memory GROUP BY, ORDER BY and joins may use for their tuples
+static size_t workMemory = 16 * 1024 * 1024;
+
+// a lookup of an index join reads a leaf of the index and a page of the
+// table at random, which costs about as much as this many pages of a scan
+static const int INDEX_PROBE_PAGES = 4;
+
 
 RC SqlEngine::run(FILE* commandline)
 {
-  fprintf(stdout, "Bruinbase> ");
+  prompt();
 
   // set the command line input and start parsing user input
   sqlin = commandline;
@@ -36,95 +69,573 @@ RC SqlEngine::run(FILE* commandline)
   return 0;
 }
 
-RC SqlEngine::select(int attr, const string& table, const vector<SelCond>& cond)
+RC SqlEngine::setReadMode(char mode)
+{
+  if (mode != 'r' && mode != 'm') return RC_INVALID_FILE_MODE;
+
+  readMode = mode;
+  return 0;
+}
+
+void SqlEngine::setOutputMode(ResultWriter::Mode mode)
+{
+  outputMode = mode;
+}
+
+void SqlEngine::setWorkMemory(size_t bytes)
+{
+  workMemory = bytes;
+}
+
+void SqlEngine::prompt()
+{
+  // the prompt would be mixed up with the rows of a TSV or binary result
+  if (outputMode == ResultWriter::TEXT) fprintf(stdout, "Bruinbase> ");
+}
+
+RC SqlEngine::setScanThreads(int n)
+{
+  if (n < 1 || n > MAX_SCAN_THREADS) return RC_INVALID_ATTRIBUTE;
+
+  scanThreads = n;
+  return 0;
+}
+
+// write the aggregate in the SELECT clause (attr 4 to 8)
+static void writeAggregate(ResultWriter& out, int attr, const Aggregate& agg)
+{
+  if (attr == 4) {  // COUNT(*)
+    out.writeInt(agg.count);
+    return;
+  }
+
+  // MIN, MAX, SUM and AVG of no tuple are NULL
+  if (agg.count == 0) {
+    out.writeNull();
+    return;
+  }
+  switch (attr) {
+  case 5:  // MIN(key)
+    out.writeInt(agg.min);
+    break;
+  case 6:  // MAX(key)
+    out.writeInt(agg.max);
+    break;
+  case 7:  // SUM(key)
+    out.writeLong(agg.sum);
+    break;
+  case 8:  // AVG(key)
+    out.writeDouble((double)agg.sum / agg.count);
+    break;
+  }
+}
+
+// returned by a sink that needs no more tuples
+static const RC SINK_FULL = 1;
+
+//
+// the receiver of the tuples of a table that satisfy the conditions
+//
+class TupleSink {
+ public:
+  virtual ~TupleSink() {}
+
+  // take the tuples at the positions sel[0..n-1] of a batch. the values
+  // are only there if they were read from the table.
+  // return SINK_FULL to stop reading the table
+  virtual RC add(const int* keys, const char* const* values, const int* sel, int n) = 0;
+};
+
+//
+// writes the selected attribute of the tuples or adds them to the aggregate.
+// the first skip tuples are not written, and no more than limit are
+//
+class ResultSink : public TupleSink {
+ public:
+  ResultSink(int a, ResultWriter* w, int offset = 0, int limit = -1)
+    : attr(a), out(w), skip(offset), left(limit) {}
+
+  RC add(const int* keys, const char* const* values, const int* sel, int n)
+  {
+    if (attr < 4) {
+      for (int i = 0; i < n && left != 0; i++) {
+        if (skip > 0) {
+          skip--;
+          continue;
+        }
+        out->writeTuple(attr, keys[sel[i]], values[sel[i]]);
+        if (left > 0) left--;
+      }
+      return (left == 0) ? SINK_FULL : 0;
+    } else if (attr == 4) {
+      agg.count += n;
+    } else {
+      agg.add(keys, sel, n);
+    }
+    return 0;
+  }
+
+  int           attr;  // the attribute in the SELECT clause
+  ResultWriter* out;   // where the tuples are written
+  int           skip;  // # tuples still to skip
+  int           left;  // # tuples still to write. -1 if there is no limit
+  Aggregate     agg;   // the aggregate of the tuples
+};
+
+//
+// adds the tuples to their groups
+//
+class GroupSink : public TupleSink {
+ public:
+  GroupSink(HashAggregate& g, bool v) : groups(g), byValue(v) {}
+
+  RC add(const int* keys, const char* const* values, const int* sel, int n)
+  {
+    RC rc;
+    for (int i = 0; i < n; i++) {
+      if ((rc = groups.add(keys[sel[i]], byValue ? values[sel[i]] : NULL)) < 0) return rc;
+    }
+    return 0;
+  }
+
+  HashAggregate& groups;
+  bool           byValue;  // are the tuples grouped by value?
+};
+
+//
+// adds the tuples to an ExternalSort, a TopK or the outer side of an IndexJoin
+//
+template<class Sorter>
+class SortSink : public TupleSink {
+ public:
+  SortSink(Sorter& s, bool v) : sorter(s), withValue(v) {}
+
+  RC add(const int* keys, const char* const* values, const int* sel, int n)
+  {
+    RC rc;
+    for (int i = 0; i < n; i++) {
+      if ((rc = sorter.add(keys[sel[i]], withValue ? values[sel[i]] : "")) < 0) return rc;
+    }
+    return 0;
+  }
+
+  Sorter& sorter;
+  bool    withValue;  // were the values read?
+};
+
+//
+// a range of the pages of a table scanned by a thread
+//
+struct ScanPart {
+  const string*    table;
+  const Predicate* pred;
+  bool   needValue;
+  bool   keyRange;
+  int    low;
+  int    high;
+  int    part;     // the range scanned, out of parts ranges
+  int    parts;
+  TupleSink* sink; // where the tuples that satisfy the conditions go
+  RC     rc;
+  bool   sinkFailed;  // did the error come from the sink?
+};
+
+// scan the pages of the part of the table and pass the tuples that
+// satisfy the conditions to the sink
+static void scanPart(ScanPart& s, const RecordFile& rf)
+{
+  vector<int> sel(rf.getRecordsPerPage());  // the positions of the tuples of
+                                            // a batch that satisfy the conditions
+  RecordFile::Scanner scanner(rf, s.needValue);
+  RC rc;
+
+  if (s.keyRange) scanner.setKeyRange(s.low, s.high);
+  scanner.setPart(s.part, s.parts);
+
+  while ((rc = scanner.next()) == 0) {
+    const int* keys = scanner.keys();
+    const char* const* values = scanner.values();
+
+    // check the conditions on the tuples of the batch. the value
+    // conditions are only checked for the tuples left by the key conditions
+    int m = s.pred->selectKeys(keys, scanner.count(), &sel[0]);
+    m = s.pred->selectValues(values, &sel[0], m);
+
+    // the conditions are met for the tuples left in sel
+    if ((rc = s.sink->add(keys, values, &sel[0], m)) != 0) {
+      s.sinkFailed = (rc < 0);
+      break;
+    }
+  }
+
+  s.rc = (rc == RC_END_OF_FILE || rc == SINK_FULL) ? 0 : rc;
+}
+
+// the body of a scan thread. the thread opens the table by itself,
+// so that it has its own file descriptors and read-ahead state
+static void* scanThread(void* arg)
+{
+  ScanPart&  s = *(ScanPart*)arg;
+  RecordFile rf;
+
+  if ((s.rc = rf.open(*s.table + ".tbl", readMode)) < 0) return NULL;
+  rf.advise(PageFile::SEQUENTIAL);
+  scanPart(s, rf);
+  rf.close();
+
+  return NULL;
+}
+
+// pass the tuples of the table that satisfy the conditions to the sinks.
+// if there is a condition on the key column and the table has an index,
+// the qualifying key range is looked up in the index and all tuples go to
+// the first sink in key order. if a keyOrder sink is given, the index is
+// used even without a key condition and the tuples go to that sink instead.
+// otherwise the table is scanned by up to one thread per sink, and every
+// thread passes its tuples to its own sink. the values are read only if
+// needValue is set. errors are printed here
+static RC readTuples(const string& table, const RecordFile& rf, const Predicate& pred,
+                     bool needValue, const vector<TupleSink*>& sinks,
+                     TupleSink* keyOrder = NULL)
+{
+  BTreeIndex idx;
+  RecordId   rid;
+  int        key;
+  int        low, high;
+  RC         rc;
+
+  bool keyRange = pred.getKeyRange(low, high);
+
+  if ((keyRange || keyOrder != NULL) && idx.open(table + ".idx", readMode) == 0) {
+    IndexCursor cursor;
+    TupleSink*  sink = (keyOrder != NULL) ? keyOrder : sinks[0];
+
+    // the tuples are fetched in key order, not in the order of the table
+    rf.advise(PageFile::RANDOM);
+
+    rc = idx.locate(low, cursor);
+    if (rc == 0 || rc == RC_NO_SUCH_RECORD) {
+      // the tuples are fetched in batches. the table pages of the tuples
+      // that satisfy the key conditions are read at the same time
+      int         keys[FETCH_BATCH];
+      RecordId    rids[FETCH_BATCH];
+      char        values[FETCH_BATCH][RecordFile::MAX_VALUE_LENGTH];
+      const char* valuePtrs[FETCH_BATCH];
+      int         sel[FETCH_BATCH];
+      bool more = true;
+
+      rc = 0;
+      while (more) {
+        int n = 0;
+        while (n < FETCH_BATCH) {
+          // the index returns the keys in the ascending order,
+          // so we are done once we go past the upper bound
+          if ((rc = idx.readForward(cursor, key, rid)) != 0 || key > high) {
+            more = false;
+            break;
+          }
+          keys[n] = key;
+          rids[n] = rid;
+          n++;
+        }
+
+        int m = pred.selectKeys(keys, n, sel);
+        if (needValue) {
+          for (int i = 0; i < m; i++) rf.prefetch(rids[sel[i]]);
+          PageFile::submit();
+
+          for (int i = 0; i < m; i++) {
+            int j = sel[i];
+            if (rf.read(rids[j], key, values[j]) < 0) {
+              fprintf(stderr, "Error: while reading a tuple from table %s\n", table.c_str());
+              idx.close();
+              return RC_FILE_READ_FAILED;
+            }
+            valuePtrs[j] = values[j];
+          }
+          m = pred.selectValues(valuePtrs, sel, m);
+        }
+
+        // the conditions are met for the tuples left in sel
+        // the index cursor stops as soon as the sink is full
+        RC sunk = sink->add(keys, valuePtrs, sel, m);
+        if (sunk < 0) {
+          fprintf(stderr, "Error: while processing the tuples of table %s\n", table.c_str());
+          idx.close();
+          return sunk;
+        }
+        if (sunk == SINK_FULL) break;
+      }
+      idx.close();
+
+      if (rc < 0 && rc != RC_END_OF_TREE) {
+        fprintf(stderr, "Error: while reading the index of table %s\n", table.c_str());
+        return rc;
+      }
+      return 0;
+    }
+
+    // the index is empty or unusable. fall back to a table scan
+    idx.close();
+  }
+
+  // scan the table file from the beginning, a page at a time.
+  // the pages without a key in the key range are skipped.
+  // a large table is split into ranges of pages scanned by several threads
+  int parts = (rf.endRid().pid + 1) / MIN_PART_PAGES;
+  if (parts > (int)sinks.size()) parts = sinks.size();
+  if (parts < 1) parts = 1;
+
+  vector<ScanPart> scans(parts);
+  for (int i = 0; i < parts; i++) {
+    ScanPart& s = scans[i];
+    s.table = &table;
+    s.pred = &pred;
+    s.needValue = needValue;
+    s.keyRange = keyRange;
+    s.low = low;
+    s.high = high;
+    s.part = i;
+    s.parts = parts;
+    s.sink = sinks[i];
+    s.rc = 0;
+    s.sinkFailed = false;
+  }
+
+  // the first part is scanned by this thread with the table opened here
+  vector<pthread_t> threads(parts);
+  vector<bool>      started(parts, false);
+  for (int i = 1; i < parts; i++) {
+    started[i] = (pthread_create(&threads[i], NULL, scanThread, &scans[i]) == 0);
+  }
+
+  rf.advise(PageFile::SEQUENTIAL);
+  scanPart(scans[0], rf);
+
+  for (int i = 1; i < parts; i++) {
+    // a part without a thread is scanned here
+    if (started[i]) pthread_join(threads[i], NULL);
+    else scanThread(&scans[i]);
+  }
+  for (int i = 0; i < parts; i++) {
+    if (scans[i].rc < 0) {
+      if (scans[i].sinkFailed) {
+        fprintf(stderr, "Error: while processing the tuples of table %s\n", table.c_str());
+      } else {
+        fprintf(stderr, "Error: while reading a tuple from table %s\n", table.c_str());
+      }
+      return scans[i].rc;
+    }
+  }
+  return 0;
+}
+
+// does the tuple (key, rid) found in the index satisfy the conditions?
+// the value of the tuple is read from the table only if it is needed
+static RC checkTuple(const Predicate& pred, const RecordFile& rf, int key, const RecordId& rid, bool& ok)
+{
+  char        value[RecordFile::MAX_VALUE_LENGTH];
+  const char* valuePtr = value;
+  int         sel[1];
+  RC          rc;
+
+  ok = pred.selectKeys(&key, 1, sel) == 1;
+  if (!ok || !pred.needsValue()) return 0;
+
+  if ((rc = rf.read(rid, key, value)) < 0) return rc;
+  ok = pred.selectValues(&valuePtr, sel, 1) == 1;
+  return 0;
+}
+
+// find MIN(key) or MAX(key) of the tuples in [low, high] that satisfy
+// the conditions at an end of the index. the search stops at the first
+// tuple that satisfies them, so without a value condition only the nodes
+// on a path from the root to a leaf are read
+static RC indexMinMax(bool max, BTreeIndex& idx, const RecordFile& rf, const Predicate& pred,
+                      int low, int high, Aggregate& agg)
+{
+  IndexCursor cursor;
+  RecordId    rid;
+  int         key;
+  bool        ok;
+  RC          rc;
+
+  if (!max) {
+    // read forward from the smallest key in the range
+    rc = idx.locate(low, cursor);
+    if (rc != 0 && rc != RC_NO_SUCH_RECORD) return (rc == RC_END_OF_TREE) ? 0 : rc;
+    while ((rc = idx.readForward(cursor, key, rid)) == 0 && key <= high) {
+      if ((rc = checkTuple(pred, rf, key, rid, ok)) < 0) return rc;
+      if (ok) {
+        agg.add(key);
+        return 0;
+      }
+    }
+    return (rc == 0 || rc == RC_END_OF_TREE) ? 0 : rc;
+  }
+
+  // there is no backward link between the leaves. look up the largest
+  // key up to high, and if no tuple with the key satisfies the conditions,
+  // the largest key smaller than it and so on
+  while (high >= low) {
+    rc = idx.locateLast(high, key, rid);
+    if (rc == RC_NO_SUCH_RECORD || rc == RC_END_OF_TREE) return 0;
+    if (rc < 0) return rc;
+    if (key < low) return 0;
+
+    // check every tuple with the key
+    int k = key;
+    if ((rc = idx.locate(k, cursor)) < 0 && rc != RC_NO_SUCH_RECORD) return rc;
+    while ((rc = idx.readForward(cursor, key, rid)) == 0 && key == k) {
+      if ((rc = checkTuple(pred, rf, key, rid, ok)) < 0) return rc;
+      if (ok) {
+        agg.add(key);
+        return 0;
+      }
+    }
+    if (rc < 0 && rc != RC_END_OF_TREE) return rc;
+
+    if (k == INT_MIN) break;
+    high = k - 1;
+  }
+  return 0;
+}
+
+// read the tuples that satisfy the conditions into the sorter and write
+// them in its order, from the offset'th one on and no more than limit.
+// the tuples that come from the index in key order go to keyOrder instead
+template<class Sorter>
+static RC sortTuples(Sorter& sorter, const string& table, const RecordFile& rf,
+                     const Predicate& pred, bool needValue, TupleSink* keyOrder,
+                     ResultWriter& out, int attr, int offset, int limit)
+{
+  SortSink<Sorter>   sink(sorter, needValue);
+  vector<TupleSink*> sinks(1, &sink);
+  int                key;
+  const char*        value;
+  RC                 rc;
+
+  if ((rc = readTuples(table, rf, pred, needValue, sinks, keyOrder)) < 0) return rc;
+
+  long long end = (limit < 0) ? LLONG_MAX : (long long)offset + limit;
+  for (long long i = 0; i < end; i++) {
+    if ((rc = sorter.next(key, value)) < 0) break;
+    if (i >= offset) out.writeTuple(attr, key, value);
+  }
+  if (rc < 0 && rc != RC_END_OF_FILE) {
+    fprintf(stderr, "Error: while sorting the tuples of table %s\n", table.c_str());
+    return rc;
+  }
+  return 0;
+}
+
+RC SqlEngine::select(int attr, const string& table, const vector<SelCond>& cond,
+                     int order, bool descending, int limit, int offset)
 {
   RecordFile rf;   // RecordFile containing the table
-  RecordId   rid;  // record cursor for table scanning
+  BTreeIndex idx;  // the index on the key column, if there is one
 
   RC     rc;
-  int    key;     
-  string value;
-  int    count;
-  int    diff;
+  int    low, high;
+  bool   needValue;
+
+  Predicate    pred(cond);  // the conditions compiled for the query
+  ResultWriter out(outputMode, stdout);  // the result of the query
+  Aggregate    agg;  // the aggregate of the tuples that satisfy the conditions
+
+  // if the conditions contradict each other, no tuple can satisfy them
+  // and the table is not read at all
+  if (pred.isEmpty()) {
+    if (access((table + ".tbl").c_str(), F_OK) < 0) {
+      fprintf(stderr, "Error: table %s does not exist\n", table.c_str());
+      return RC_FILE_OPEN_FAILED;
+    }
+    if (attr >= 4 && offset == 0 && limit != 0) writeAggregate(out, attr, agg);
+    return out.flush();
+  }
 
   // open the table file
-  if ((rc = rf.open(table + ".tbl", 'r')) < 0) {
+  if ((rc = rf.open(table + ".tbl", readMode)) < 0) {
     fprintf(stderr, "Error: table %s does not exist\n", table.c_str());
     return rc;
   }
 
-  // scan the table file from the beginning
-  rid.pid = rid.sid = 0;
-  count = 0;
-  while (rid < rf.endRid()) {
-    // read the tuple
-    if ((rc = rf.read(rid, key, value)) < 0) {
-      fprintf(stderr, "Error: while reading a tuple from table %s\n", table.c_str());
+  // an aggregate is a single row, so ORDER BY does not change it
+  // and LIMIT applies to the row instead of the tuples
+  if (attr >= 4) order = 0;
+  int skip = (attr < 4) ? offset : 0;
+  int left = (attr < 4) ? limit : -1;
+
+  // the values have to be read from the table only if the value
+  // column is printed, used in a condition or the sort column
+  needValue = (attr == 2 || attr == 3 || order == 2 || pred.needsValue());
+
+  // MIN(key) and MAX(key) are found at an end of the index
+  if ((attr == 5 || attr == 6) && idx.open(table + ".idx", readMode) == 0) {
+    pred.getKeyRange(low, high);
+    rf.advise(PageFile::RANDOM);
+    rc = indexMinMax(attr == 6, idx, rf, pred, low, high, agg);
+    idx.close();
+    if (rc < 0) {
+      fprintf(stderr, "Error: while reading the index of table %s\n", table.c_str());
       goto exit_select;
     }
+  } else if (order != 0) {
+    // the tuples are sorted unless they come from the index in key order
+    ResultSink resultSink(attr, &out, skip, left);
+    TupleSink* keyOrder = (order == 1 && !descending) ? &resultSink : NULL;
 
-    // check the conditions on the tuple
-    for (unsigned i = 0; i < cond.size(); i++) {
-      // compute the difference between the tuple value and the condition value
-      switch (cond[i].attr) {
-      case 1:
-	diff = key - atoi(cond[i].value);
-	break;
-      case 2:
-	diff = strcmp(value.c_str(), cond[i].value);
-	break;
-      }
+    // only the first tuples are kept if they fit in memory.
+    // otherwise all tuples are sorted
+    if (limit >= 0 && TopK::fits((long long)offset + limit, workMemory)) {
+      TopK topk(order == 2, descending, offset + limit);
+      rc = sortTuples(topk, table, rf, pred, needValue, keyOrder, out, attr, offset, limit);
+    } else {
+      ExternalSort sorter(order == 2, descending, table, workMemory);
+      rc = sortTuples(sorter, table, rf, pred, needValue, keyOrder, out, attr, offset, limit);
+    }
+    if (rc < 0) goto exit_select;
+  } else {
+    // every scan thread has its own sink. the first one writes its tuples
+    // right away. the others write theirs to temporary files, which are
+    // copied out after them, so that the tuples come out in the order of
+    // the table and only a buffer per thread is in memory. if a file
+    // cannot be created, the tuples of its thread are kept in memory.
+    // with a limit, the table is scanned by this thread alone and the
+    // scan stops once the sink has the tuples it needs
+    int threads = (left >= 0) ? 1 : scanThreads;
 
-      // skip the tuple if any condition is not met
-      switch (cond[i].comp) {
-      case SelCond::EQ:
-	if (diff != 0) goto next_tuple;
-	break;
-      case SelCond::NE:
-	if (diff == 0) goto next_tuple;
-	break;
-      case SelCond::GT:
-	if (diff <= 0) goto next_tuple;
-	break;
-      case SelCond::LT:
-	if (diff >= 0) goto next_tuple;
-	break;
-      case SelCond::GE:
-	if (diff < 0) goto next_tuple;
-	break;
-      case SelCond::LE:
-	if (diff > 0) goto next_tuple;
-	break;
-      }
+    vector<FILE*>        spilled(threads, (FILE*)NULL);
+    vector<ResultWriter> kept;
+    vector<ResultSink>   results;
+    vector<TupleSink*>   sinks;
+    kept.reserve(threads);
+    for (int i = 0; i < threads; i++) {
+      if (i > 0) spilled[i] = tmpfile();
+      kept.push_back(ResultWriter(outputMode, spilled[i]));
+      results.push_back(ResultSink(attr, (i == 0) ? &out : &kept[i], skip, left));
     }
+    for (int i = 0; i < threads; i++) sinks.push_back(&results[i]);
 
-    // the condition is met for the tuple. 
-    // increase matching tuple counter
-    count++;
+    rc = readTuples(table, rf, pred, needValue, sinks);
 
-    // print the tuple 
-    switch (attr) {
-    case 1:  // SELECT key
-      fprintf(stdout, "%d\n", key);
-      break;
-    case 2:  // SELECT value
-      fprintf(stdout, "%s\n", value.c_str());
-      break;
-    case 3:  // SELECT *
-      fprintf(stdout, "%d '%s'\n", key, value.c_str());
-      break;
+    // the writers of the files are emptied before the files are closed
+    for (int i = 0; i < threads; i++) {
+      if (i > 0 && rc >= 0) rc = out.append(kept[i]);
+      if (spilled[i] != NULL) {
+        kept[i].flush();
+        fclose(spilled[i]);
+      }
+      agg.merge(results[i].agg);
     }
-
-    // move to the next tuple
-    next_tuple:
-    ++rid;
+    if (rc < 0) goto exit_select;
   }
 
-  // print matching tuple count if "select count(*)"
-  if (attr == 4) {
-    fprintf(stdout, "%d\n", count);
+  // print the aggregate if the SELECT clause is one
+  if (attr >= 4 && offset == 0 && limit != 0) {
+    writeAggregate(out, attr, agg);
   }
-  rc = 0;
+  rc = out.flush();
 
   // close the table file and return
   exit_select:
@@ -132,7 +643,344 @@ RC SqlEngine::select(int attr, const string& table, const vector<SelCond>& cond)
   return rc;
 }
 
-RC SqlEngine::load(const string& table, const string& loadfile, bool index)
+RC SqlEngine::selectGroups(const vector<int>& attrs, int group,
+                           const string& table, const vector<SelCond>& cond,
+                           int limit, int offset)
+{
+  RecordFile rf;
+  RC         rc;
+
+  // every item of the SELECT clause has a single value for a group
+  for (unsigned i = 0; i < attrs.size(); i++) {
+    if (attrs[i] == 3 || (attrs[i] < 3 && attrs[i] != group)) {
+      fprintf(stderr, "Error: only the GROUP BY column and aggregates can be selected\n");
+      return RC_INVALID_ATTRIBUTE;
+    }
+  }
+
+  Predicate    pred(cond);
+  ResultWriter out(outputMode, stdout);
+
+  // no tuple satisfies the conditions, so there is no group
+  if (pred.isEmpty()) {
+    if (access((table + ".tbl").c_str(), F_OK) < 0) {
+      fprintf(stderr, "Error: table %s does not exist\n", table.c_str());
+      return RC_FILE_OPEN_FAILED;
+    }
+    return 0;
+  }
+
+  if ((rc = rf.open(table + ".tbl", readMode)) < 0) {
+    fprintf(stderr, "Error: table %s does not exist\n", table.c_str());
+    return rc;
+  }
+
+  // the groups are spilled next to the table. the groups are built by
+  // a single sink, so the table is scanned by one thread
+  HashAggregate      groups(group == 2, table, workMemory);
+  GroupSink          sink(groups, group == 2);
+  vector<TupleSink*> sinks(1, &sink);
+
+  rc = readTuples(table, rf, pred, group == 2 || pred.needsValue(), sinks);
+  rf.close();
+  if (rc < 0) return rc;
+
+  // print a row for every group from the offset'th one on
+  int         key = 0;
+  const char* value = NULL;
+  Aggregate   agg;
+  for (long long n = 0; limit < 0 || n < (long long)offset + limit; n++) {
+    if ((rc = groups.next(key, value, agg)) < 0) break;
+    if (n < offset) continue;
+
+    out.beginRow(attrs.size());
+    for (unsigned i = 0; i < attrs.size(); i++) {
+      switch (attrs[i]) {
+      case 1: out.putColumn(key); break;
+      case 2: out.putColumn(value); break;
+      case 4: out.putColumn(agg.count); break;
+      case 5: out.putColumn(agg.min); break;
+      case 6: out.putColumn(agg.max); break;
+      case 7: out.putColumn(agg.sum); break;
+      case 8: out.putColumn((double)agg.sum / agg.count); break;
+      }
+    }
+    out.endRow();
+  }
+  if (rc < 0 && rc != RC_END_OF_FILE) {
+    fprintf(stderr, "Error: while grouping the tuples of table %s\n", table.c_str());
+    return rc;
+  }
+  return out.flush();
+}
+
+//
+// adds the tuples of the build table of a join to the hash table
+//
+class BuildSink : public TupleSink {
+ public:
+  BuildSink(HashJoin& j, bool v) : join(j), withValue(v) {}
+
+  RC add(const int* keys, const char* const* values, const int* sel, int n)
+  {
+    RC rc;
+    for (int i = 0; i < n; i++) {
+      if ((rc = join.build(keys[sel[i]], withValue ? values[sel[i]] : "")) < 0) return rc;
+    }
+    return 0;
+  }
+
+  HashJoin& join;
+  bool      withValue;  // were the values read?
+};
+
+//
+// joins the tuples of the probe table of a join with the build tuples.
+// the table is not read any more once the output is full
+//
+class ProbeSink : public TupleSink {
+ public:
+  ProbeSink(HashJoin& j, HashJoin::Output& o, bool v) : join(j), out(o), withValue(v) {}
+
+  RC add(const int* keys, const char* const* values, const int* sel, int n)
+  {
+    RC rc;
+    for (int i = 0; i < n; i++) {
+      if ((rc = join.probe(keys[sel[i]], withValue ? values[sel[i]] : "", out)) != 0) return rc;
+    }
+    return 0;
+  }
+
+  HashJoin&         join;
+  HashJoin::Output& out;
+  bool              withValue;  // were the values read?
+};
+
+//
+// a column of the SELECT clause of a join
+//
+struct JoinColumn {
+  int table;  // 0: the first table, 1: the second table in the FROM clause
+  int attr;   // attribute as in SqlEngine::select()
+};
+
+//
+// writes the columns of the rows of a join or adds them to the aggregate.
+// the first skip rows are not written, and no more than limit are
+//
+class JoinSink : public HashJoin::Output {
+ public:
+  JoinSink(const vector<JoinColumn>& c, int b, ResultWriter* w, int offset = 0, int limit = -1)
+    : columns(c), buildTable(b), out(w), skip(offset), left(limit) {}
+
+  RC match(int buildKey, const char* buildValue, int probeKey, const char* probeValue)
+  {
+    int         keys[2];
+    const char* values[2];
+
+    if (left == 0) return SINK_FULL;
+
+    keys[buildTable] = buildKey;
+    values[buildTable] = buildValue;
+    keys[1 - buildTable] = probeKey;
+    values[1 - buildTable] = probeValue;
+
+    // an aggregate is the only item of the SELECT clause
+    if (columns[0].attr >= 4) {
+      agg.add(keys[columns[0].table]);
+      return 0;
+    }
+
+    if (skip > 0) {
+      skip--;
+      return 0;
+    }
+    out->beginRow(columns.size());
+    for (unsigned i = 0; i < columns.size(); i++) {
+      if (columns[i].attr == 1) out->putColumn(keys[columns[i].table]);
+      else out->putColumn(values[columns[i].table]);
+    }
+    out->endRow();
+    if (left > 0) left--;
+
+    return (left == 0) ? SINK_FULL : 0;
+  }
+
+  const vector<JoinColumn>& columns;
+  int           buildTable;  // the table of the build tuples (0 or 1)
+  ResultWriter* out;   // where the rows are written
+  int           skip;  // # rows still to skip
+  int           left;  // # rows still to write. -1 if there is no limit
+  Aggregate     agg;   // the aggregate of the rows
+};
+
+// find the table (0 or 1) that qualifies a column of a join.
+// errors are printed here
+static int tableOf(const char* name, const string& table1, const string& table2)
+{
+  if (name == NULL) {
+    fprintf(stderr, "Error: a column of a join must be qualified by %s or %s\n",
+            table1.c_str(), table2.c_str());
+    return -1;
+  }
+  if (table1 == name) return 0;
+  if (table2 == name) return 1;
+  fprintf(stderr, "Error: table %s is not in the FROM clause\n", name);
+  return -1;
+}
+
+RC SqlEngine::join(const vector<SelColumn>& attrs, const string& table1, const string& table2,
+                   const vector<JoinCond>& conds, int limit, int offset)
+{
+  const string*      tables[2] = { &table1, &table2 };
+  vector<JoinColumn> columns;   // the columns of the SELECT clause
+  vector<SelCond>    cond[2];   // the conditions on each table
+  int                joinAttr = 0;  // the column the tables are joined on
+  RecordFile         rf[2];
+  RC                 rc;
+  int                t;
+
+  if (table1 == table2) {
+    fprintf(stderr, "Error: a table cannot be joined with itself\n");
+    return RC_INVALID_ATTRIBUTE;
+  }
+
+  // find the table of every item of the SELECT clause
+  for (unsigned i = 0; i < attrs.size(); i++) {
+    JoinColumn c;
+    if (attrs[i].attr == 3 && attrs[i].table == NULL) {  // * is both tables
+      for (c.table = 0; c.table < 2; c.table++) {
+        for (c.attr = 1; c.attr <= 2; c.attr++) columns.push_back(c);
+      }
+      continue;
+    }
+    if (attrs[i].attr == 4 && attrs[i].table == NULL) {  // COUNT(*)
+      c.table = 0;
+    } else if ((c.table = tableOf(attrs[i].table, table1, table2)) < 0) {
+      return RC_INVALID_ATTRIBUTE;
+    }
+    c.attr = attrs[i].attr;
+    columns.push_back(c);
+  }
+  for (unsigned i = 0; i < columns.size(); i++) {
+    if (columns[i].attr >= 4 && columns.size() > 1) {
+      fprintf(stderr, "Error: an aggregate of a join must be the only item in the SELECT clause\n");
+      return RC_INVALID_ATTRIBUTE;
+    }
+  }
+
+  // split the conditions between the tables, and find the join condition
+  for (unsigned i = 0; i < conds.size(); i++) {
+    const JoinCond& c = conds[i];
+    if ((t = tableOf(c.table, table1, table2)) < 0) return RC_INVALID_ATTRIBUTE;
+    if (c.other.table == NULL) {
+      cond[t].push_back(c.cond);
+      continue;
+    }
+
+    int u = tableOf(c.other.table, table1, table2);
+    if (u < 0) return RC_INVALID_ATTRIBUTE;
+    if (u == t || c.cond.attr != c.other.attr || c.cond.comp != SelCond::EQ || joinAttr != 0) {
+      fprintf(stderr, "Error: a join needs a single condition %s.column = %s.column\n",
+              table1.c_str(), table2.c_str());
+      return RC_INVALID_ATTRIBUTE;
+    }
+    joinAttr = c.cond.attr;
+  }
+  if (joinAttr == 0) {
+    fprintf(stderr, "Error: a join needs a condition %s.column = %s.column\n",
+            table1.c_str(), table2.c_str());
+    return RC_INVALID_ATTRIBUTE;
+  }
+
+  // the joined tuples have the same join column, so the conditions on it
+  // hold for both tables. this narrows the key range read from each table
+  unsigned n0 = cond[0].size(), n1 = cond[1].size();
+  for (unsigned i = 0; i < n0; i++) if (cond[0][i].attr == joinAttr) cond[1].push_back(cond[0][i]);
+  for (unsigned i = 0; i < n1; i++) if (cond[1][i].attr == joinAttr) cond[0].push_back(cond[1][i]);
+
+  for (t = 0; t < 2; t++) {
+    if ((rc = rf[t].open(*tables[t] + ".tbl", readMode)) < 0) {
+      fprintf(stderr, "Error: table %s does not exist\n", tables[t]->c_str());
+      if (t == 1) rf[0].close();
+      return rc;
+    }
+  }
+
+  Predicate    pred0(cond[0]);
+  Predicate    pred1(cond[1]);
+  Predicate*   pred[2] = { &pred0, &pred1 };
+  ResultWriter out(outputMode, stdout);
+
+  // a hash table is built on the smaller table and probed with the larger
+  // one. if they are joined on the key, the larger one has an index and the
+  // smaller one is small enough, its keys are looked up in the index instead
+  int        small = (rf[1].endRid().pid < rf[0].endRid().pid) ? 1 : 0;
+  int        large = 1 - small;
+  long long  smallTuples = (long long)(rf[small].endRid().pid + 1) * rf[small].getRecordsPerPage();
+  BTreeIndex idx;
+  bool       indexJoin = (joinAttr == 1 && smallTuples * INDEX_PROBE_PAGES < rf[large].endRid().pid + 1
+                          && idx.open(*tables[large] + ".idx", readMode) == 0);
+
+  // the large table gives the build tuples of an index join
+  bool aggregate = (columns[0].attr >= 4);
+  JoinSink result(columns, indexJoin ? large : small, &out, aggregate ? 0 : offset, aggregate ? -1 : limit);
+
+  // the values of a table are read only if they are printed,
+  // used in a condition or the join column
+  bool needValue[2];
+  for (t = 0; t < 2; t++) {
+    needValue[t] = (joinAttr == 2 || pred[t]->needsValue());
+    for (unsigned i = 0; i < columns.size(); i++) {
+      if (columns[i].table == t && columns[i].attr == 2) needValue[t] = true;
+    }
+  }
+
+  // if the conditions on a table contradict each other, no row is joined
+  rc = 0;
+  if (pred0.isEmpty() || pred1.isEmpty()) {
+    // nothing to read
+  } else if (indexJoin) {
+    // the small table is read by a single thread into the index join, and
+    // the tuples of the large table are fetched in the order of the index
+    IndexJoin           ij(idx, rf[large], *pred[large], needValue[large], *tables[small], workMemory);
+    SortSink<IndexJoin> outerSink(ij, needValue[small]);
+    vector<TupleSink*>  sinks(1, &outerSink);
+
+    rf[large].advise(PageFile::RANDOM);
+    rc = readTuples(*tables[small], rf[small], *pred[small], needValue[small], sinks);
+    if (rc == 0 && (rc = ij.finish(result)) < 0) {
+      fprintf(stderr, "Error: while joining tables %s and %s\n", table1.c_str(), table2.c_str());
+    }
+  } else {
+    HashJoin           hj(joinAttr == 2, *tables[small], workMemory);
+    BuildSink          buildSink(hj, needValue[small]);
+    ProbeSink          probeSink(hj, result, needValue[large]);
+    vector<TupleSink*> sinks(1, &buildSink);
+
+    // each table is read by a single thread into the hash join
+    rc = readTuples(*tables[small], rf[small], *pred[small], needValue[small], sinks);
+    if (rc == 0) {
+      sinks[0] = &probeSink;
+      rc = readTuples(*tables[large], rf[large], *pred[large], needValue[large], sinks);
+    }
+    if (rc == 0 && result.left != 0 && (rc = hj.finish(result)) < 0) {
+      fprintf(stderr, "Error: while joining tables %s and %s\n", table1.c_str(), table2.c_str());
+    }
+  }
+  if (indexJoin) idx.close();
+  rf[0].close();
+  rf[1].close();
+  if (rc < 0) return rc;
+
+  // print the aggregate if the SELECT clause is one
+  if (aggregate && offset == 0 && limit != 0) {
+    writeAggregate(out, columns[0].attr, result.agg);
+  }
+  return out.flush();
+}
+
+RC SqlEngine::load(const string& table, const string& loadfile, bool index, RecordFile::Format format)
 {
   RecordFile rf;
 
@@ -146,7 +994,7 @@ RC SqlEngine::load(const string& table, const string& loadfile, bool index)
     return -1001;
   }
 
-  if (rf.open(table_name, 'w') != 0){
+  if (rf.open(table_name, 'w', format) != 0){
     cerr << "ON LOAD - Error opening RecordFile for writing";
     return RC_FILE_OPEN_FAILED;
   }
@@ -169,7 +1017,17 @@ RC SqlEngine::load(const string& table, const string& loadfile, bool index)
   RecordId rid;
 
   if(index==true) {
-    bti.open(table + ".idx",'w');
+    if(bti.open(table + ".idx",'w')!=0) {
+      cerr << "ON LOAD - Error opening the index file for writing";
+      rf.close();
+      return RC_FILE_OPEN_FAILED;
+    }
+
+    //A new index is built bottom-up after all pairs are collected,
+    //which writes every index page once. An existing index gets
+    //the new pairs inserted one by one
+
+    bool bulk = (bti.beginBulkLoad()==0);
 
     //Once opened, we need to get each line
     //And start inseting each pair into the BTree
@@ -182,9 +1040,14 @@ RC SqlEngine::load(const string& table, const string& loadfile, bool index)
       //At this point, if there has been no error -> then it's ready to insert the pair
       //Will need to insert pair of key and rid into BTree
 
-      if(bti.insert(key,rid)!=0){return RC_FILE_WRITE_FAILED;}
+      if(bulk) {
+        if(bti.bulkInsert(key,rid)!=0){return RC_FILE_WRITE_FAILED;}
+      }
+      else if(bti.insert(key,rid)!=0){return RC_FILE_WRITE_FAILED;}
     }
 
+    if(bulk && bti.endBulkLoad()!=0){return RC_FILE_WRITE_FAILED;}
+
     bti.close(); //Closes the index tree & file
   }
 
@@ -13,6 +13,7 @@
 #include <vector>
 #include "Bruinbase.h"
 #include "RecordFile.h"
+#include "ResultWriter.h"
 
 /**
  * data structure to represent a condition in the WHERE clause
@@ -23,6 +24,25 @@ struct SelCond {
   char* value;  // the value to compare
 };
 
+/**
+ * data structure to represent a column in the SELECT or WHERE clause,
+ * which may be qualified by the name of its table
+ */
+struct SelColumn {
+  char* table;  // the table name before the dot. NULL if not qualified
+  int   attr;   // attribute: as in SqlEngine::select()
+};
+
+/**
+ * data structure to represent a condition in the WHERE clause that may
+ * be qualified by a table name, or that compares the columns of two tables
+ */
+struct JoinCond {
+  char*     table;  // the table of cond.attr. NULL if not qualified
+  SelCond   cond;   // cond.value is NULL if the column is compared with other
+  SelColumn other;  // the column on the right. other.table is NULL if there is none
+};
+
 /**
  * the class that takes, parses, and executes the user commands.
  */
@@ -43,21 +63,105 @@ class SqlEngine {
    * all conditions in conds must be ANDed together.
    * the result of the SELECT is printed on screen.
    * @param attr[IN] attribute in the SELECT clause
-   * (1: key, 2: value, 3: *, 4: count(*))
+   * (1: key, 2: value, 3: *, 4: count(*),
+   *  5: min(key), 6: max(key), 7: sum(key), 8: avg(key))
    * @param table[IN] the table name in the FROM clause
    * @param conds[IN] list of conditions in the WHERE clause
+   * @param order[IN] the column in the ORDER BY clause (1: key, 2: value).
+   * 0 to return the tuples in any order
+   * @param descending[IN] true to return the largest tuple first
+   * @param limit[IN] # tuples returned at most. -1 if there is no limit
+   * @param offset[IN] # tuples skipped before the first one returned
+   * @return error code. 0 if no error
+   */
+  static RC select(int attr, const std::string& table, const std::vector<SelCond>& conds,
+                   int order = 0, bool descending = false, int limit = -1, int offset = 0);
+
+  /**
+   * executes a SELECT statement with a GROUP BY clause.
+   * one row is printed for every group, with a column for every item
+   * of the SELECT clause, in no particular order.
+   * @param attrs[IN] the items in the SELECT clause. each is the GROUP BY
+   * column or an aggregate (see select())
+   * @param group[IN] the column in the GROUP BY clause (1: key, 2: value)
+   * @param table[IN] the table name in the FROM clause
+   * @param conds[IN] list of conditions in the WHERE clause
+   * @param limit[IN] # groups returned at most. -1 if there is no limit
+   * @param offset[IN] # groups skipped before the first one returned
+   * @return error code. 0 if no error
+   */
+  static RC selectGroups(const std::vector<int>& attrs, int group,
+                         const std::string& table, const std::vector<SelCond>& conds,
+                         int limit = -1, int offset = 0);
+
+  /**
+   * executes a SELECT statement on two tables joined on a column.
+   * the WHERE clause must have exactly one condition that compares the
+   * same column of the two tables with =. every other condition and
+   * every column of the SELECT clause is qualified by its table name.
+   * the rows come from a hash join, or from an index join if the tables
+   * are joined on the key and the larger one has an index and is much
+   * larger than the other.
+   * @param attrs[IN] the items in the SELECT clause. they are either
+   * columns (* is all the columns of both tables) or a single aggregate
+   * @param table1[IN] the first table name in the FROM clause
+   * @param table2[IN] the second table name in the FROM clause
+   * @param conds[IN] list of conditions in the WHERE clause
+   * @param limit[IN] # rows returned at most. -1 if there is no limit
+   * @param offset[IN] # rows skipped before the first one returned
    * @return error code. 0 if no error
    */
-  static RC select(int attr, const std::string& table, const std::vector<SelCond>& conds);
+  static RC join(const std::vector<SelColumn>& attrs,
+                 const std::string& table1, const std::string& table2,
+                 const std::vector<JoinCond>& conds, int limit = -1, int offset = 0);
+
+  /**
+   * set the mode used to open tables and indexes for SELECT.
+   * @param mode[IN] 'r' to read the pages through the buffer pool (default),
+   *                 'm' to memory-map the files
+   * @return error code. 0 if no error
+   */
+  static RC setReadMode(char mode);
+
+  /**
+   * set the number of threads that scan a table for SELECT.
+   * a table is split into ranges of pages that are scanned at the same time.
+   * @param n[IN] # threads (1 by default, at most MAX_SCAN_THREADS)
+   * @return error code. 0 if no error
+   */
+  static RC setScanThreads(int n);
+
+  /**
+   * set the format of the tuples returned by SELECT.
+   * the prompt is printed only with the TEXT format (default).
+   * @param mode[IN] the format of the tuples
+   */
+  static void setOutputMode(ResultWriter::Mode mode);
+
+  /**
+   * set the memory that GROUP BY, ORDER BY and joins may use for their tuples.
+   * the tuples that do not fit are spilled to temporary files.
+   * @param bytes[IN] the memory budget (16MB by default)
+   */
+  static void setWorkMemory(size_t bytes);
+
+  /**
+   * print the prompt for the next command.
+   */
+  static void prompt();
+
+  static const int MAX_SCAN_THREADS = 64;
 
   /**
    * load a table from a load file.
    * @param table[IN] the table name in the LOAD command
    * @param loadfile[IN] the file name of the load file
    * @param index[IN] true if "WITH INDEX" option was specified
+   * @param format[IN] the record format of the table if it is created
    * @return error code. 0 if no error
    */
-  static RC load(const std::string& table, const std::string& loadfile, bool index);
+  static RC load(const std::string& table, const std::string& loadfile, bool index,
+                 RecordFile::Format format = RecordFile::FIXED);
 
   /**
    * parse a line from the load file into the (key, value) pair.
@@ -1,5 +1,6 @@
 %{
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <sys/times.h>
 #include <unistd.h>
@@ -8,24 +9,225 @@
 #include "Bruinbase.h"
 #include "SqlEngine.h" 
 #include "PageFile.h"
+#include "BufferPool.h"
 
 int  sqllex(void);  
 void sqlerror(const char *str) { fprintf(stderr, "Error: %s\n", str); }
 extern "C" { int  sqlwrap() { return 1; } }
 
-static void runSelect(int attr, const char* table, const std::vector<SelCond>& conds)
+// the clauses of a SELECT after the WHERE clause
+struct SelectClauses {
+  int  group;       // the column in GROUP BY (1: key, 2: value). 0 if none
+  int  order;       // the column in ORDER BY. 0 if none
+  bool descending;  // DESC in ORDER BY
+  int  limit;       // the number in LIMIT. -1 if none
+  int  offset;      // the number in OFFSET. 0 if none
+};
+
+// the column named by a word
+static int columnOf(const char* word)
+{
+  if (strcasecmp(word, "key") == 0) return 1;
+  if (strcasecmp(word, "value") == 0) return 2;
+  return 0;
+}
+
+// the non-negative number in a word
+static bool countOf(const char* word, int& n)
+{
+  char* end;
+  long  v = strtol(word, &end, 10);
+  if (*word < '0' || *word > '9' || *end != 0 || v > INT_MAX) return false;
+  n = v;
+  return true;
+}
+
+// read the clauses from the words after the WHERE clause. the words are
+// not keywords of the lexer, so that a table or a column may still be
+// named like them
+static bool parseClauses(const std::vector<char*>& words, SelectClauses& c)
 {
+  unsigned i = 0;
+  unsigned n = words.size();
+
+  c.group = 0;
+  c.order = 0;
+  c.descending = false;
+  c.limit = -1;
+  c.offset = 0;
+
+  if (i + 2 < n && strcasecmp(words[i], "group") == 0 && strcasecmp(words[i + 1], "by") == 0) {
+    if ((c.group = columnOf(words[i + 2])) == 0) {
+      sqlerror("wrong GROUP BY column. neither key or value");
+      return false;
+    }
+    i += 3;
+  }
+
+  if (i + 2 < n && strcasecmp(words[i], "order") == 0 && strcasecmp(words[i + 1], "by") == 0) {
+    if ((c.order = columnOf(words[i + 2])) == 0) {
+      sqlerror("wrong ORDER BY column. neither key or value");
+      return false;
+    }
+    i += 3;
+    if (i < n && strcasecmp(words[i], "asc") == 0) {
+      i++;
+    } else if (i < n && strcasecmp(words[i], "desc") == 0) {
+      c.descending = true;
+      i++;
+    }
+  }
+
+  if (i < n && strcasecmp(words[i], "limit") == 0) {
+    if (i + 1 >= n || !countOf(words[i + 1], c.limit)) {
+      sqlerror("wrong LIMIT. a non-negative number expected");
+      return false;
+    }
+    i += 2;
+    if (i < n && strcasecmp(words[i], "offset") == 0) {
+      if (i + 1 >= n || !countOf(words[i + 1], c.offset)) {
+        sqlerror("wrong OFFSET. a non-negative number expected");
+        return false;
+      }
+      i += 2;
+    }
+  }
+
+  if (i < n) {
+    sqlerror("syntax error. GROUP BY, ORDER BY or LIMIT expected");
+    return false;
+  }
+  return true;
+}
+
+// the aggregate function of a name (4: count, 5: min, 6: max, 7: sum, 8: avg).
+// 0 if there is none
+static int aggregateOf(const char* name)
+{
+  if (strcasecmp(name, "count") == 0) return 4;
+  if (strcasecmp(name, "min") == 0) return 5;
+  if (strcasecmp(name, "max") == 0) return 6;
+  if (strcasecmp(name, "sum") == 0) return 7;
+  if (strcasecmp(name, "avg") == 0) return 8;
+  sqlerror("wrong aggregate function. neither count, min, max, sum or avg");
+  return 0;
+}
+
+// is a column of a SELECT on a single table qualified by another table?
+static bool otherTable(const char* qualifier, const char* table)
+{
+  if (qualifier == NULL || strcmp(qualifier, table) == 0) return false;
+  fprintf(stderr, "Error: table %s is not in the FROM clause\n", qualifier);
+  return true;
+}
+
+// the items and the conditions of a SELECT on a single table
+static bool singleTable(const std::vector<SelColumn>& columns, const std::vector<JoinCond>& joinConds,
+                        const char* table, std::vector<int>& attrs, std::vector<SelCond>& conds)
+{
+  for (unsigned i = 0; i < columns.size(); i++) {
+    if (otherTable(columns[i].table, table)) return false;
+    attrs.push_back(columns[i].attr);
+  }
+  for (unsigned i = 0; i < joinConds.size(); i++) {
+    if (otherTable(joinConds[i].table, table)) return false;
+    if (joinConds[i].other.table != NULL) {
+      sqlerror("a column can only be compared with a column of another table");
+      return false;
+    }
+    conds.push_back(joinConds[i].cond);
+  }
+  return true;
+}
+
+// free the strings of the items and the conditions of a SELECT
+static void freeSelect(std::vector<SelColumn>* columns, std::vector<JoinCond>* conds)
+{
+  for (unsigned i = 0; i < columns->size(); i++) {
+    free((*columns)[i].table);
+  }
+  delete columns;
+  for (unsigned i = 0; i < conds->size(); i++) {
+    free((*conds)[i].table);
+    free((*conds)[i].cond.value);
+    free((*conds)[i].other.table);
+  }
+  delete conds;
+}
+
+static void runSelect(const std::vector<SelColumn>& columns, const SelectClauses& clauses, const char* table, const char* table2, const std::vector<JoinCond>& joinConds)
+{
+  std::vector<int>     attrs;
+  std::vector<SelCond> conds;
+
   struct tms tmsbuf;
   clock_t btime, etime;
   int     bpagecnt, epagecnt;
+  int     bcallcnt, ecallcnt;
+  int     bhitcnt, ehitcnt;
+  int     bmisscnt, emisscnt;
+  int     bevictcnt, eevictcnt;
 
   btime = times(&tmsbuf);
   bpagecnt = PageFile::getPageReadCount();
-  SqlEngine::select(attr, table, conds);
+  bcallcnt = PageFile::getReadCallCount();
+  bhitcnt = BufferPool::getHitCount();
+  bmisscnt = BufferPool::getMissCount();
+  bevictcnt = BufferPool::getEvictionCount();
+  if (table2 != NULL) {
+    if (clauses.group != 0 || clauses.order != 0) {
+      fprintf(stderr, "Error: GROUP BY and ORDER BY are not supported with a join\n");
+    } else {
+      SqlEngine::join(columns, table, table2, joinConds, clauses.limit, clauses.offset);
+    }
+  } else if (!singleTable(columns, joinConds, table, attrs, conds)) {
+    // the error is printed
+  } else if (clauses.group != 0 && clauses.order != 0) {
+    fprintf(stderr, "Error: ORDER BY is not supported with GROUP BY\n");
+  } else if (clauses.group != 0) {
+    SqlEngine::selectGroups(attrs, clauses.group, table, conds, clauses.limit, clauses.offset);
+  } else if (attrs.size() == 1) {
+    SqlEngine::select(attrs[0], table, conds, clauses.order, clauses.descending,
+                      clauses.limit, clauses.offset);
+  } else {
+    fprintf(stderr, "Error: several items in the SELECT clause need GROUP BY\n");
+  }
   etime = times(&tmsbuf);
   epagecnt = PageFile::getPageReadCount();
+  ecallcnt = PageFile::getReadCallCount();
+  ehitcnt = BufferPool::getHitCount();
+  emisscnt = BufferPool::getMissCount();
+  eevictcnt = BufferPool::getEvictionCount();
+
+  fprintf(stderr, "  -- %.3f seconds to run the select command. Read %d pages in %d read calls\n", ((float)(etime - btime))/sysconf(_SC_CLK_TCK), epagecnt - bpagecnt, ecallcnt - bcallcnt);
+  fprintf(stderr, "  -- buffer pool: %d hits, %d misses, %d evictions\n", ehitcnt - bhitcnt, emisscnt - bmisscnt, eevictcnt - bevictcnt);
+}
+
+// the options of the LOAD command after WITH
+static const int LOAD_INDEX    = 1;  // build an index on the key column
+static const int LOAD_SLOTTED  = 2;  // store the table in the SLOTTED format
+static const int LOAD_COLUMNAR = 4;  // store the table in the COLUMNAR format
+
+static void runLoad(const char* table, const char* loadfile, int options)
+{
+  struct tms tmsbuf;
+  clock_t btime, etime;
+  int     bpagecnt, epagecnt;
+  int     bflushcnt, eflushcnt;
+  RecordFile::Format format = RecordFile::FIXED;
+
+  if (options & LOAD_SLOTTED) format = RecordFile::SLOTTED;
+  if (options & LOAD_COLUMNAR) format = RecordFile::COLUMNAR;
 
-  fprintf(stderr, "  -- %.3f seconds to run the select command. Read %d pages\n", ((float)(etime - btime))/sysconf(_SC_CLK_TCK), epagecnt - bpagecnt);
+  btime = times(&tmsbuf);
+  bpagecnt = PageFile::getPageWriteCount();
+  bflushcnt = BufferPool::getFlushCount();
+  SqlEngine::load(table, loadfile, (options & LOAD_INDEX) != 0, format);
+  etime = times(&tmsbuf);
+  epagecnt = PageFile::getPageWriteCount();
+  eflushcnt = BufferPool::getFlushCount();
+
+  fprintf(stderr, "  -- %.3f seconds to run the load command. Wrote %d pages in %d write calls\n", ((float)(etime - btime))/sysconf(_SC_CLK_TCK), epagecnt - bpagecnt, eflushcnt - bflushcnt);
 }
 
 %}
@@ -33,19 +235,25 @@ static void runSelect(int attr, const char* table, const std::vector<SelCond>& c
 %union {
   int integer;
   char* string;
-  SelCond* cond;
-  std::vector<SelCond>* conds;
+  SelColumn column;
+  JoinCond* cond;
+  std::vector<JoinCond>* conds;
+  std::vector<SelColumn>* columns;
+  std::vector<char*>* words;
 }
 
 %token SELECT FROM WHERE LOAD WITH INDEX QUIT COUNT AND OR 
-%token COMMA STAR LF
+%token COMMA STAR LPAREN RPAREN DOT LF
 %token <string> INTEGER STRING ID
 %token EQUAL NEQUAL LESS LESSEQUAL GREATER GREATEREQUAL 
 
-%type <integer> attributes attribute comparator
+%type <integer> attribute comparator load_options load_option
 %type <string> table value
+%type <column> attributes
 %type <cond> condition
-%type <conds> conditions
+%type <conds> conditions where_clause
+%type <columns> select_list
+%type <words> words
 %%
 
 commands:
@@ -54,11 +262,11 @@ commands:
 	;
 
 command:
-        load_command { fprintf(stdout, "Bruinbase> "); }
-	| select_command { fprintf(stdout, "Bruinbase> "); }
+        load_command { SqlEngine::prompt(); }
+	| select_command { SqlEngine::prompt(); }
 	| quit_command
-	| error LF { fprintf(stdout, "Bruinbase> "); }
-	| LF { fprintf(stdout, "Bruinbase> "); }
+	| error LF { SqlEngine::prompt(); }
+	| LF { SqlEngine::prompt(); }
 	;
 
 quit_command:
@@ -67,36 +275,93 @@ quit_command:
 
 load_command:
 	LOAD table FROM STRING LF { 
-	  SqlEngine::load(std::string($2), std::string($4), false); 
+	  runLoad($2, $4, 0);
 	  free($2);
 	  free($4);
 	}
-	| LOAD table FROM STRING WITH INDEX LF { 
-	  SqlEngine::load(std::string($2), std::string($4), true); 
+	| LOAD table FROM STRING WITH load_options LF { 
+	  runLoad($2, $4, $6);
 	  free($2);
 	  free($4);
 	}
 	;
 
+load_options:
+	load_option { $$ = $1; }
+	| load_options COMMA load_option { $$ = $1 | $3; }
+	;
+
+load_option:
+	INDEX { $$ = LOAD_INDEX; }
+	| ID {
+		if (strcasecmp($1, "slotted") == 0) $$ = LOAD_SLOTTED;
+		else if (strcasecmp($1, "columnar") == 0) $$ = LOAD_COLUMNAR;
+		else if (strcasecmp($1, "fixed") == 0) $$ = 0;
+		else {
+		  sqlerror("wrong load option. neither index, fixed, slotted or columnar");
+		  free($1);
+		  YYERROR;
+		}
+		free($1);
+	}
+	;
+
 select_command:
-	SELECT attributes FROM table LF {
-   	        std::vector<SelCond> conds;
-		runSelect($2, $4, conds);
+	SELECT select_list FROM table where_clause words LF {
+		SelectClauses clauses;
+		if (parseClauses(*$6, clauses)) runSelect(*$2, clauses, $4, NULL, *$5);
 		free($4);
+		freeSelect($2, $5);
+		for (unsigned i = 0; i < $6->size(); i++) {
+		    free((*$6)[i]);
+		}
+		delete $6;
 	}
-	| SELECT attributes FROM table WHERE conditions LF {
-	        runSelect($2, $4, *$6);
-	  	free($4);
-	  	for (unsigned i = 0; i < $6->size(); i++) {
-		    free((*$6)[i].value);
+	| SELECT select_list FROM table COMMA table where_clause words LF {
+		SelectClauses clauses;
+		if (parseClauses(*$8, clauses)) runSelect(*$2, clauses, $4, $6, *$7);
+		free($4);
+		free($6);
+		freeSelect($2, $7);
+		for (unsigned i = 0; i < $8->size(); i++) {
+		    free((*$8)[i]);
 		}
-	  	delete $6;
+		delete $8;
+	}
+	;
+
+select_list:
+	attributes {
+	  std::vector<SelColumn>* v = new std::vector<SelColumn>;
+	  v->push_back($1);
+	  $$ = v;
+	}
+	| select_list COMMA attributes {
+	  $1->push_back($3);
+	  $$ = $1;
+	}
+	;
+
+where_clause:
+	/* empty */ { $$ = new std::vector<JoinCond>; }
+	| WHERE conditions { $$ = $2; }
+	;
+
+words:
+	/* empty */ { $$ = new std::vector<char*>; }
+	| words ID {
+	  $1->push_back($2);
+	  $$ = $1;
+	}
+	| words INTEGER {
+	  $1->push_back($2);
+	  $$ = $1;
 	}
 	;
 
 conditions:
 	condition {
-	  std::vector<SelCond>* v = new std::vector<SelCond>;
+	  std::vector<JoinCond>* v = new std::vector<JoinCond>;
 	  v->push_back(*$1);
 	  $$ = v;
           delete $1;
@@ -110,18 +375,66 @@ conditions:
 
 condition:
 	attribute comparator value { 
-	  SelCond* c = new SelCond;
-	  c->attr = $1;
-	  c->comp = static_cast<SelCond::Comparator>($2);
-	  c->value = $3;
+	  JoinCond* c = new JoinCond;
+	  c->table = NULL;
+	  c->cond.attr = $1;
+	  c->cond.comp = static_cast<SelCond::Comparator>($2);
+	  c->cond.value = $3;
+	  c->other.table = NULL;
+	  c->other.attr = 0;
 	  $$ = c;
         }
+	| ID DOT attribute comparator value {
+	  JoinCond* c = new JoinCond;
+	  c->table = $1;
+	  c->cond.attr = $3;
+	  c->cond.comp = static_cast<SelCond::Comparator>($4);
+	  c->cond.value = $5;
+	  c->other.table = NULL;
+	  c->other.attr = 0;
+	  $$ = c;
+	}
+	| ID DOT attribute comparator ID DOT attribute {
+	  JoinCond* c = new JoinCond;
+	  c->table = $1;
+	  c->cond.attr = $3;
+	  c->cond.comp = static_cast<SelCond::Comparator>($4);
+	  c->cond.value = NULL;
+	  c->other.table = $5;
+	  c->other.attr = $7;
+	  $$ = c;
+	}
 	;
 
 attributes:
-	attribute { $$ = $1; }
-	| STAR  { $$ = 3; }
-	| COUNT { $$ = 4; }
+	attribute { $$.table = NULL; $$.attr = $1; }
+	| ID DOT attribute { $$.table = $1; $$.attr = $3; }
+	| STAR  { $$.table = NULL; $$.attr = 3; }
+	| COUNT { $$.table = NULL; $$.attr = 4; }
+	| ID LPAREN attribute RPAREN {
+		$$.table = NULL;
+		$$.attr = aggregateOf($1);
+		free($1);
+		if ($$.attr == 0) YYERROR;
+		if ($$.attr != 4 && $3 != 1) {
+		  sqlerror("min, max, sum and avg are only supported on the key column");
+		  YYERROR;
+		}
+	}
+	| ID LPAREN ID DOT attribute RPAREN {
+		$$.table = $3;
+		$$.attr = aggregateOf($1);
+		free($1);
+		if ($$.attr == 0) {
+		  free($3);
+		  YYERROR;
+		}
+		if ($$.attr != 4 && $5 != 1) {
+		  sqlerror("min, max, sum and avg are only supported on the key column");
+		  free($3);
+		  YYERROR;
+		}
+	}
 	;
 
 attribute:
@@ -0,0 +1,87 @@
+/*
+ * TopK: the first tuples of an ORDER BY ... LIMIT kept in a bounded heap.
+ */
+
+#include "TopK.h"
+#include <algorithm>
+#include <cstring>
+
+TopK::TopK(bool value, bool desc, int n)
+  : byValue(value), descending(desc), k(n), seq(0), returning(false), nextEntry(0)
+{
+}
+
+bool TopK::fits(long long k, size_t budget)
+{
+  return k <= (long long)(budget / (sizeof(Entry) + sizeof(unsigned)));
+}
+
+bool TopK::before(int key, const char* value, unsigned s, const Entry& e) const
+{
+  int c;
+  if (byValue) c = strcmp(value, e.value);
+  else c = (key < e.key) ? -1 : (key > e.key);
+
+  if (c != 0) return descending ? c > 0 : c < 0;
+  return s < e.seq;
+}
+
+bool TopK::Before::operator()(unsigned a, unsigned b) const
+{
+  const Entry& e = topk->entries[a];
+  return topk->before(e.key, e.value, e.seq, topk->entries[b]);
+}
+
+RC TopK::add(int key, const char* value)
+{
+  unsigned i;
+
+  if (returning) return RC_INVALID_ATTRIBUTE;
+
+  unsigned s = seq++;
+  if (k == 0) return 0;
+
+  Before order = { this };
+  if (heap.size() < k) {
+    i = entries.size();
+    entries.push_back(Entry());
+  } else {
+    // a tuple after the last one kept is not among the first k
+    if (!before(key, value, s, entries[heap.front()])) return 0;
+
+    // the last tuple kept makes room for the new one
+    std::pop_heap(heap.begin(), heap.end(), order);
+    i = heap.back();
+    heap.pop_back();
+  }
+
+  Entry& e = entries[i];
+  e.key = key;
+  e.seq = s;
+  size_t length = strlen(value);
+  if (length >= sizeof(e.value)) length = sizeof(e.value) - 1;
+  memcpy(e.value, value, length);
+  e.value[length] = 0;
+
+  heap.push_back(i);
+  std::push_heap(heap.begin(), heap.end(), order);
+
+  return 0;
+}
+
+RC TopK::next(int& key, const char*& value)
+{
+  if (!returning) {
+    Before order = { this };
+    std::sort_heap(heap.begin(), heap.end(), order);
+    returning = true;
+    nextEntry = 0;
+  }
+
+  if (nextEntry >= heap.size()) return RC_END_OF_FILE;
+
+  const Entry& e = entries[heap[nextEntry++]];
+  key = e.key;
+  value = e.value;
+  return 0;
+}
@@ -0,0 +1,83 @@
+/*
+ * TopK: the first tuples of an ORDER BY ... LIMIT kept in a bounded heap.
+ */
+
+#ifndef TOPK_H
+#define TOPK_H
+
+#include <vector>
+#include "Bruinbase.h"
+#include "RecordFile.h"
+
+/**
+ * Keeps the first k of the (key, value) tuples added to it in the order
+ * of the key or the value column.
+ *
+ * The tuples are kept in a heap whose top is the tuple that comes last,
+ * so a new tuple that does not come before it is dropped without being
+ * copied, and one that does replaces it. Tuples with equal sort columns
+ * are returned in the order they were added, as by ExternalSort.
+ */
+class TopK {
+ public:
+  /**
+   * @param byValue[IN] true to sort by the value column, false for the key column
+   * @param descending[IN] true to keep the largest tuples
+   * @param k[IN] # tuples to keep
+   */
+  TopK(bool byValue, bool descending, int k);
+
+  /**
+   * can k tuples be kept in the memory budget?
+   * @param k[IN] # tuples to keep
+   * @param budget[IN] # bytes the tuples may use
+   * @return true if they fit
+   */
+  static bool fits(long long k, size_t budget);
+
+  /**
+   * add a tuple.
+   * @param key[IN] the key of the tuple
+   * @param value[IN] the value of the tuple
+   * @return error code. 0 if no error
+   */
+  RC add(int key, const char* value);
+
+  /**
+   * get the next of the tuples kept, in the sort order.
+   * no tuple may be added once a tuple is returned.
+   * @param key[OUT] the key of the tuple
+   * @param value[OUT] the value of the tuple
+   * @return error code. RC_END_OF_FILE if there is no more tuple
+   */
+  RC next(int& key, const char*& value);
+
+ private:
+  struct Entry {
+    int      key;
+    unsigned seq;  // # tuples added before this one
+    char     value[RecordFile::MAX_VALUE_LENGTH];
+  };
+
+  // orders the entries by their index. the heap is built with it,
+  // so its top is the last entry
+  struct Before {
+    const TopK* topk;
+    bool operator()(unsigned a, unsigned b) const;
+  };
+
+  bool before(int key, const char* value, unsigned seq, const Entry& e) const;
+
+  bool     byValue;
+  bool     descending;
+  unsigned k;
+  unsigned seq;      // # tuples added so far
+
+  std::vector<Entry>    entries;  // the tuples kept
+  std::vector<unsigned> heap;     // the heap of the indexes of entries
+
+  bool     returning;  // are the tuples being returned?
+  unsigned nextEntry;  // the next tuple in heap to return
+};
+
+#endif // TOPK_H
@@ -9,10 +9,86 @@
  
 #include "Bruinbase.h"
 #include "SqlEngine.h"
+#include "BufferPool.h"
+#include "PageFile.h"
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <stdint.h>
 
-int main()
+static void usage(const char* prog)
 {
+  fprintf(stderr, "usage: %s [-b buffer_pool_megabytes] [-p page_kilobytes] [-m] [-t threads] [-o text|tsv|binary] [-w work_megabytes]\n", prog);
+  fprintf(stderr, "  -b: the size of the buffer pool in megabytes\n");
+  fprintf(stderr, "  -p: the page size of new tables and indexes in kilobytes (1, 2, 4, 8 or 16)\n");
+  fprintf(stderr, "  -m: memory-map tables and indexes for SELECT\n");
+  fprintf(stderr, "  -t: the number of threads that scan a table for SELECT\n");
+  fprintf(stderr, "  -o: the format of the tuples returned by SELECT\n");
+  fprintf(stderr, "  -w: the memory in megabytes GROUP BY, ORDER BY and joins may use before they spill to disk\n");
+}
+
+// parse a size given in units of 'unit' bytes. the size has to be a
+// positive decimal number of at most 'limit' bytes
+static bool parseSize(const char* s, size_t unit, size_t limit, size_t& bytes)
+{
+  char* end;
+
+  if (!isdigit((unsigned char)*s)) return false;
+  errno = 0;
+  unsigned long long n = strtoull(s, &end, 10);
+  if (*end != '\0' || errno != 0 || n == 0 || n > limit / unit) return false;
+
+  bytes = (size_t)n * unit;
+  return true;
+}
+
+int main(int argc, char* argv[])
+{
+  size_t bytes;
+
+  // process the command line options
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+      if (!parseSize(argv[++i], 1024 * 1024, SIZE_MAX, bytes) || BufferPool::setPoolSize(bytes) < 0) {
+        fprintf(stderr, "Error: invalid buffer pool size %s\n", argv[i]);
+        return 1;
+      }
+    } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+      if (!parseSize(argv[++i], 1024, INT_MAX, bytes) || PageFile::setDefaultPageSize((int)bytes) < 0) {
+        fprintf(stderr, "Error: invalid page size %s\n", argv[i]);
+        return 1;
+      }
+    } else if (strcmp(argv[i], "-m") == 0) {
+      SqlEngine::setReadMode('m');
+    } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+      if (SqlEngine::setScanThreads(atoi(argv[++i])) < 0) {
+        fprintf(stderr, "Error: invalid number of threads %s\n", argv[i]);
+        return 1;
+      }
+    } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+      const char* format = argv[++i];
+      if (strcmp(format, "text") == 0) SqlEngine::setOutputMode(ResultWriter::TEXT);
+      else if (strcmp(format, "tsv") == 0) SqlEngine::setOutputMode(ResultWriter::TSV);
+      else if (strcmp(format, "binary") == 0) SqlEngine::setOutputMode(ResultWriter::BINARY);
+      else {
+        fprintf(stderr, "Error: invalid output format %s\n", format);
+        return 1;
+      }
+    } else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+      if (!parseSize(argv[++i], 1024 * 1024, SIZE_MAX, bytes)) {
+        fprintf(stderr, "Error: invalid work memory size %s\n", argv[i]);
+        return 1;
+      }
+      SqlEngine::setWorkMemory(bytes);
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
   // run the SQL engine taking user commands from standard input (console).
   SqlEngine::run(stdin);
 
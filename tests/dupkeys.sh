@@ -0,0 +1,91 @@
+#!/bin/sh
+#
+# regression check for duplicate keys that span a b+tree leaf boundary.
+# the lookups and joins through the index must return the same tuples
+# as a scan or a hash join of the same data without an index.
+#
+# usage: sh tests/dupkeys.sh [path to bruinbase]
+#
+
+BRUINBASE=$(cd "$(dirname "${1:-./bruinbase}")" && pwd)/$(basename "${1:-./bruinbase}")
+if [ ! -x "$BRUINBASE" ]; then
+  echo "FAIL $BRUINBASE is not executable"
+  exit 1
+fi
+WORK=$(mktemp -d "${TMPDIR:-/tmp}/dupkeys.XXXXXX") || exit 1
+trap 'rm -rf "$WORK"' EXIT
+cd "$WORK" || exit 1
+
+failed=0
+
+# run the queries in a file and print the results without the prompts
+query()
+{
+  "$BRUINBASE" < "$1" 2>/dev/null | sed 's/Bruinbase> //g' | grep -v '^$'
+}
+
+check()
+{
+  if [ -s "$2" ] && cmp -s "$2" "$3"; then
+    echo "ok   $1"
+  else
+    echo "FAIL $1"
+    diff "$2" "$3" | head -5
+    failed=1
+  fi
+}
+
+# 10000 keys with 1 to 4 tuples each, in a scrambled order, and
+# a small table with every 37th key
+awk 'BEGIN {
+  for (i = 0; i < 10000; i++) {
+    k = (i * 7919) % 10000
+    for (j = 0; j <= k % 4; j++) printf "%d,\"v%d_%d\"\n", k * 7 - 30000, k, j
+  }
+}' > dup.del
+awk 'BEGIN { for (k = 0; k < 10000; k += 37) printf "%d,\"s%d\"\n", k * 7 - 30000, k }' > small.del
+
+# bi is bulk loaded. ii gets the tuples of dup.del inserted one by one
+# into the index built for small.del. bn, ni and sm have no index
+cat > load.sql <<EOF
+load sm from 'small.del'
+load bi from 'dup.del' with index
+load bn from 'dup.del'
+load ii from 'small.del' with index
+load ii from 'dup.del' with index
+load ni from 'small.del'
+load ni from 'dup.del'
+EOF
+"$BRUINBASE" < load.sql > /dev/null 2>&1
+
+# every key, and ranges whose ends are duplicate keys
+awk 'BEGIN { for (k = 0; k < 10000; k++) print k * 7 - 30000 }' > keys
+for t in bi bn ii ni; do
+  awk -v t=$t '{ printf "select count(*) from %s where key = %d\n", t, $1 }' keys > eq_$t.sql
+  awk -v t=$t 'NR % 97 == 0 {
+    printf "select count(*) from %s where key >= %d and key <= %d\n", t, $1, $1 + 700
+    printf "select min(key) from %s where key >= %d and key <= %d\n", t, $1, $1 + 700
+    printf "select max(key) from %s where key >= %d and key <= %d\n", t, $1, $1 + 700
+  }' keys > range_$t.sql
+  query eq_$t.sql > eq_$t.out
+  query range_$t.sql > range_$t.out
+done
+
+# the joins with bi and ii probe the index, the joins with bn and ni
+# build a hash table
+for t in bi bn ii ni; do
+  cat > join_$t.sql <<EOF
+select count(*) from sm, $t where sm.key = $t.key
+select sm.value, $t.value from sm, $t where sm.key = $t.key
+EOF
+  query join_$t.sql | sort > join_$t.out
+done
+
+check "key = K, bulk loaded index"        eq_bn.out eq_bi.out
+check "key range, bulk loaded index"      range_bn.out range_bi.out
+check "key = K, index built by inserts"   eq_ni.out eq_ii.out
+check "key range, index built by inserts" range_ni.out range_ii.out
+check "index join, bulk loaded index"     join_bn.out join_bi.out
+check "index join, index built by inserts" join_ni.out join_ii.out
+
+exit $failed